@@ -0,0 +1,93 @@
+#include "band.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "hal.h"
+
+using namespace Band;
+
+namespace
+{
+    // Class limits in timer ticks, compared right in the interrupt
+    constexpr uint16_t classLimitsTicks[classesCount - 1] = {
+        classLimitsUs[0] * Hal::Timer::ticksPerUs,
+        classLimitsUs[1] * Hal::Timer::ticksPerUs,
+        classLimitsUs[2] * Hal::Timer::ticksPerUs,
+        classLimitsUs[3] * Hal::Timer::ticksPerUs,
+    };
+    static_assert(classesCount == 5);
+    static_assert((unsigned long)classLimitsUs[classesCount - 2] * Hal::Timer::ticksPerUs <= UINT16_MAX);
+
+    volatile uint16_t counts[classesCount];
+    uint16_t lastEdgeTicks = 0;
+    uint8_t bandInterrupt = 0;
+    unsigned long windowStartTimeMs = 0;
+
+    /**
+     * @brief External interrupt handler, counts the edge in the class of the ended level
+     */
+    void onEdge()
+    {
+        uint16_t ticks = Hal::Timer::getTicks();
+        uint16_t widthTicks = ticks - lastEdgeTicks;
+        lastEdgeTicks = ticks;
+
+        uint8_t widthClass = 0;
+        while (widthClass < classesCount - 1 && widthTicks >= classLimitsTicks[widthClass])
+        {
+            widthClass++;
+        }
+        counts[widthClass]++;
+    }
+} // namespace
+
+/**
+ * @brief Start counting, the first window starts now
+ *
+ * @param interrupt External interrupt number
+ */
+void Band::start(uint8_t interrupt)
+{
+    bandInterrupt = interrupt;
+
+    uint8_t state = Hal::Interrupts::lock();
+    memset((void *)counts, 0, sizeof(counts));
+    lastEdgeTicks = Hal::Timer::getTicks();
+    Hal::Interrupts::restore(state);
+
+    windowStartTimeMs = Hal::Clock::millis();
+    Hal::Gpio::attachInterrupt(bandInterrupt, onEdge);
+}
+
+/**
+ * @brief Stop counting
+ */
+void Band::stop()
+{
+    Hal::Gpio::detachInterrupt(bandInterrupt);
+}
+
+/**
+ * @brief Take counters of the window since start or the previous call, the next window starts now
+ *
+ * @param window Object to copy the counters
+ */
+void Band::read(Window &window)
+{
+    uint8_t state = Hal::Interrupts::lock();
+    memcpy(window.counts, (const void *)counts, sizeof(window.counts));
+    memset((void *)counts, 0, sizeof(counts));
+    Hal::Interrupts::restore(state);
+
+    unsigned long currentTimeMs = Hal::Clock::millis();
+    window.durationMs = currentTimeMs - windowStartTimeMs;
+    windowStartTimeMs = currentTimeMs;
+
+    window.edgesCount = 0;
+    for (uint8_t widthClass = 0; widthClass < classesCount; widthClass++)
+    {
+        window.edgesCount += window.counts[widthClass];
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Radio band activity counter
+ *
+ * Every level change of the RX pin is counted by the external interrupt in the class of the
+ * level width, the caller takes the counters once per time window. The interrupt only reads
+ * the free running timer and increments one counter, so it can run alongside sending
+ * and drawing. Levels longer than the timer wrap (about 32 ms) are counted as shorter ones.
+ * Band owns the external interrupt, Receiver and Capture should be stopped while it runs.
+ */
+namespace Band
+{
+    // Number of level width classes
+    static constexpr uint8_t classesCount = 5;
+    // Upper limits of the level width classes except the last one, microseconds
+    static constexpr uint16_t classLimitsUs[classesCount - 1] = {150, 600, 2000, 10000};
+
+    /**
+     * @brief Edge counters of a time window
+     */
+    struct Window
+    {
+        // Edges per level width class
+        uint16_t counts[classesCount];
+        // Edges of all classes
+        uint16_t edgesCount;
+        // Window duration, milliseconds
+        uint16_t durationMs;
+    };
+
+    /**
+     * @brief Start counting, the first window starts now
+     *
+     * @param interrupt External interrupt number
+     */
+    void start(uint8_t interrupt);
+
+    /**
+     * @brief Stop counting
+     */
+    void stop();
+
+    /**
+     * @brief Take counters of the window since start or the previous call, the next window starts now
+     *
+     * @param window Object to copy the counters
+     */
+    void read(Window &window);
+} // namespace Band
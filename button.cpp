@@ -2,7 +2,7 @@
 
 #include <stdint.h>
 
-#include <Arduino.h>
+#include "hal.h"
 
 using namespace Button;
 
@@ -31,22 +31,22 @@ namespace
         {
             .id = Id::Up,
             .pin = 4,
-            .activeLevel = LOW,
+            .activeLevel = Hal::Gpio::levelLow,
         },
         {
             .id = Id::Down,
             .pin = 5,
-            .activeLevel = LOW,
+            .activeLevel = Hal::Gpio::levelLow,
         },
         {
             .id = Id::Left,
             .pin = 6,
-            .activeLevel = LOW,
+            .activeLevel = Hal::Gpio::levelLow,
         },
         {
             .id = Id::Right,
             .pin = 7,
-            .activeLevel = LOW,
+            .activeLevel = Hal::Gpio::levelLow,
         },
     };
 } // namespace
@@ -58,7 +58,7 @@ void Button::initialize()
 {
     for (const ButtonItem &button : buttonList)
     {
-        pinMode(button.pin, INPUT_PULLUP);
+        Hal::Gpio::setMode(button.pin, Hal::Gpio::Mode::InputPullup);
     }
 }
 
@@ -71,14 +71,14 @@ Id Button::process()
 {
     Id id = Id::None;
     // Get current system time
-    unsigned long currentTimeMs = millis();
+    unsigned long currentTimeMs = Hal::Clock::millis();
 
     for (ButtonItem &button : buttonList)
     {
         button.event = Event::None; // No action by default
 
         // Read current pin level
-        uint8_t buttonPinLevel = digitalRead(button.pin);
+        uint8_t buttonPinLevel = Hal::Gpio::read(button.pin);
         if (buttonPinLevel == button.activeLevel)
         {
             // Pin is active
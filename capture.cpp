@@ -0,0 +1,129 @@
+#include "capture.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hal.h"
+
+using namespace Capture;
+
+namespace
+{
+    static_assert((bufferSize & (bufferSize - 1)) == 0);
+    constexpr uint8_t indexMask = bufferSize - 1;
+
+    volatile uint16_t buffer[bufferSize];
+    // Written by the interrupt only
+    volatile uint8_t head = 0;
+    // Written by the caller only
+    volatile uint8_t tail = 0;
+    volatile uint16_t overflowCount = 0;
+
+    // Timer counter wrap fits the edge record duration
+    static_assert(UINT16_MAX / Hal::Timer::ticksPerUs <= durationMaxUs);
+    // Difference of millis() and the counter time above which the counter has wrapped, milliseconds
+    // (millis() is off by up to 2 ms, one counter wrap adds about 32 ms)
+    constexpr unsigned long wrapGuardMs = 8;
+
+    Hal::Gpio::PortPin capturePin;
+    uint8_t captureInterrupt = 0;
+    uint16_t lastEdgeTicks = 0;
+    unsigned long lastEdgeTimeMs = 0;
+
+    /**
+     * @brief External interrupt handler, stores the edge record
+     */
+    void onEdge()
+    {
+        uint16_t ticks = Hal::Timer::getTicks();
+        unsigned long timeMs = Hal::Clock::millis();
+        uint16_t durationUs = (uint16_t)(ticks - lastEdgeTicks) / Hal::Timer::ticksPerUs;
+        if (timeMs - lastEdgeTimeMs > (durationUs >> 10) + wrapGuardMs)
+        {
+            // Level is longer than the counter wrap
+            durationUs = durationMaxUs;
+        }
+        lastEdgeTicks = ticks;
+        lastEdgeTimeMs = timeMs;
+
+        uint8_t nextHead = (head + 1) & indexMask;
+        if (nextHead == tail)
+        {
+            overflowCount++;
+            return;
+        }
+
+        uint16_t edge = durationUs;
+        if (Hal::Gpio::readPort(capturePin) == Hal::Gpio::levelHigh)
+        {
+            edge |= levelMask;
+        }
+        buffer[head] = edge;
+        head = nextHead;
+    }
+} // namespace
+
+/**
+ * @brief Start capture, buffered edges and overflow counter are reset
+ *
+ * @param interrupt External interrupt number
+ * @param pin Pin of the external interrupt
+ */
+void Capture::start(uint8_t interrupt, uint8_t pin)
+{
+    capturePin = Hal::Gpio::getPortPin(pin);
+    captureInterrupt = interrupt;
+    head = 0;
+    tail = 0;
+    overflowCount = 0;
+
+    uint8_t state = Hal::Interrupts::lock();
+    lastEdgeTicks = Hal::Timer::getTicks();
+    lastEdgeTimeMs = Hal::Clock::millis();
+    Hal::Interrupts::restore(state);
+    Hal::Gpio::attachInterrupt(captureInterrupt, onEdge);
+}
+
+/**
+ * @brief Stop capture
+ */
+void Capture::stop()
+{
+    Hal::Gpio::detachInterrupt(captureInterrupt);
+}
+
+/**
+ * @brief Move buffered edges to the caller
+ *
+ * @param edges Buffer for edge records
+ * @param countMax Size of the buffer, edge records
+ * @return Number of edge records read
+ */
+uint8_t Capture::read(uint16_t *edges, uint8_t countMax)
+{
+    // Edges stored after this point are left for the next call
+    uint8_t currentHead = head;
+    uint8_t currentTail = tail;
+    uint8_t count = 0;
+
+    while (currentTail != currentHead && count < countMax)
+    {
+        edges[count++] = buffer[currentTail];
+        currentTail = (currentTail + 1) & indexMask;
+    }
+    tail = currentTail;
+
+    return count;
+}
+
+/**
+ * @brief Return number of edges dropped since start because the buffer was full
+ */
+uint16_t Capture::getOverflowCount()
+{
+    uint8_t state = Hal::Interrupts::lock();
+    uint16_t result = overflowCount;
+    Hal::Interrupts::restore(state);
+
+    return result;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Raw radio edge capture
+ *
+ * Every level change of the RX pin is timestamped with the free running timer counter by the
+ * external interrupt and stored in a single-producer single-consumer ring buffer, the caller
+ * drains it in batches.
+ * The interrupt only writes the head and the caller only writes the tail, so no locking
+ * is needed. Edges arriving while the buffer is full are dropped and counted.
+ * Capture owns the external interrupt, Receiver should be stopped while it runs.
+ */
+namespace Capture
+{
+    // Number of buffered edges, power of two
+    static constexpr uint8_t bufferSize = 128;
+    // Edge record: level after the edge in the top bit, time since the previous edge below it
+    static constexpr uint16_t levelMask = 0x8000;
+    static constexpr uint16_t durationMaxUs = 0x7FFF;
+
+    /**
+     * @brief Start capture, buffered edges and overflow counter are reset
+     *
+     * @param interrupt External interrupt number
+     * @param pin Pin of the external interrupt
+     */
+    void start(uint8_t interrupt, uint8_t pin);
+
+    /**
+     * @brief Stop capture
+     */
+    void stop();
+
+    /**
+     * @brief Move buffered edges to the caller
+     *
+     * @param edges Buffer for edge records
+     * @param countMax Size of the buffer, edge records
+     * @return Number of edge records read
+     */
+    uint8_t read(uint16_t *edges, uint8_t countMax);
+
+    /**
+     * @brief Return number of edges dropped since start because the buffer was full
+     */
+    uint16_t getOverflowCount();
+
+    /**
+     * @brief Return level after the edge
+     *
+     * @param edge Edge record
+     * @return Hal::Gpio level
+     */
+    inline uint8_t getLevel(uint16_t edge)
+    {
+        return ((edge & levelMask) != 0) ? 1 : 0;
+    }
+
+    /**
+     * @brief Return time since the previous edge, that is duration of the previous level
+     *
+     * @param edge Edge record
+     * @return Duration, microseconds (durationMaxUs for longer times)
+     */
+    inline uint16_t getDuration(uint16_t edge)
+    {
+        return edge & durationMaxUs;
+    }
+} // namespace Capture
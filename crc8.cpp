@@ -0,0 +1,75 @@
+#include "crc8.h"
+
+#include <stdint.h>
+
+#include "hal.h"
+
+using namespace Crc8;
+
+namespace
+{
+    constexpr uint8_t polynomial = 0x07;
+
+    /**
+     * @brief Shift CRC by the number of bits
+     *
+     * @param crc Current CRC value
+     * @param bitsCount Number of bits to shift
+     * @return New CRC value
+     */
+    constexpr uint8_t shift(uint8_t crc, uint8_t bitsCount)
+    {
+        return (bitsCount == 0) ? crc
+                                : shift((crc & 0x80) ? (uint8_t)((crc << 1) ^ polynomial) : (uint8_t)(crc << 1),
+                                        bitsCount - 1);
+    }
+
+    /**
+     * @brief CRC table holder, values are generated by TableBuilder
+     */
+    template <uint8_t... values>
+    struct Table
+    {
+        static const uint8_t data[sizeof...(values)];
+    };
+
+    template <uint8_t... values>
+    const uint8_t Table<values...>::data[sizeof...(values)] PROGMEM = {values...};
+
+    /**
+     * @brief Prepend CRC of the byte (count - 1) to the table values
+     */
+    template <uint16_t count, uint8_t... values>
+    struct TableBuilder : TableBuilder<count - 1, shift(count - 1, 8), values...>
+    {
+    };
+
+    template <uint8_t... values>
+    struct TableBuilder<0, values...>
+    {
+        typedef Table<values...> Type;
+    };
+
+    typedef TableBuilder<256>::Type CrcTable;
+    static_assert(sizeof(CrcTable::data) == 256);
+} // namespace
+
+/**
+ * @brief Calculate CRC of the data
+ *
+ * @param data Data to calculate
+ * @param length Data length, bytes
+ * @return CRC value
+ */
+uint8_t Crc8::calculate(const void *data, uint16_t length)
+{
+    const uint8_t *pData = (const uint8_t *)data;
+    uint8_t crc = 0;
+
+    while (length-- > 0)
+    {
+        crc = pgm_read_byte(&CrcTable::data[crc ^ *pData++]);
+    }
+
+    return crc;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Table-driven CRC-8 (polynomial 0x07, zero initial value, no reflection)
+ *
+ * Same result as calcCRC8() of the CRC library with default parameters, the table is
+ * generated at compile time and placed in the program memory.
+ */
+namespace Crc8
+{
+    /**
+     * @brief Calculate CRC of the data
+     *
+     * @param data Data to calculate
+     * @param length Data length, bytes
+     * @return CRC value
+     */
+    uint8_t calculate(const void *data, uint16_t length);
+} // namespace Crc8
@@ -2,9 +2,11 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 
-#include <ssd1306.h>
+#include "hal.h"
 
 using namespace Display;
 
@@ -32,8 +34,8 @@ namespace
     Size sizePermanent = Size::Font_6x8;
     Size sizeInUse = sizePermanent;
 
-    // ssd1306 display font style
-    EFontStyle fontStyle = STYLE_NORMAL;
+    // Screen font style
+    Hal::Screen::Style fontStyle = Hal::Screen::Style::Normal;
 
     // Local buffer for text string
     char buffer[textSize6x8LengthMax + 1];
@@ -41,6 +43,200 @@ namespace
     uint8_t charWidthPix = textSize6x8CharWidthPix;
     // Maximum length of the text
     uint8_t lengthMax = textSize6x8LengthMax;
+
+    // Cell attributes: inverted mode in bit 0, font style in bits 1-2
+    constexpr uint8_t attrInverted = 0x01;
+    constexpr uint8_t attrStyleShift = 1;
+    // Cell which content on the screen is not known, never matches a printed character
+    constexpr char cellUnknown = '\0';
+    // Unchanged characters between two changed ones are sent again if this is cheaper
+    // than starting another transfer, characters
+    constexpr uint8_t runGapMax = 1;
+
+    /**
+     * @brief Characters shown on the display line
+     */
+    struct ShadowLine
+    {
+        char chars[textSize6x8LengthMax];
+        uint8_t attrs[textSize6x8LengthMax];
+        // Font size of the cells
+        Size size;
+        // Line has nothing printed since the screen was cleared
+        bool isBlank;
+    };
+
+    ShadowLine shadowLines[static_cast<uint8_t>(Line::Count)];
+
+    /**
+     * @brief Reset line content to blank, as cleared screen shows it
+     *
+     * @param line Line identifier
+     */
+    void resetShadow(Line line)
+    {
+        ShadowLine &shadow = shadowLines[(uint8_t)line];
+        memset(shadow.chars, ' ', sizeof(shadow.chars));
+        memset(shadow.attrs, 0, sizeof(shadow.attrs));
+        shadow.size = (line == Line::Header) ? Size::Font_8x16 : Size::Font_6x8;
+        shadow.isBlank = true;
+    }
+
+    /**
+     * @brief Mark line content as not known, all of it is printed next time
+     *
+     * @param line Line identifier
+     */
+    void invalidateShadow(Line line)
+    {
+        ShadowLine &shadow = shadowLines[(uint8_t)line];
+        memset(shadow.chars, cellUnknown, sizeof(shadow.chars));
+        shadow.isBlank = false;
+    }
+
+    /**
+     * @brief Return attributes of the printed character
+     *
+     * @param ch Character
+     * @return Cell attributes, blank space has none since it looks the same in any style
+     */
+    inline uint8_t getCellAttrs(char ch)
+    {
+        if (ch == ' ' && isInvertedInUse == false)
+        {
+            return 0;
+        }
+
+        return ((isInvertedInUse == true) ? attrInverted : 0) | ((uint8_t)styleInUse << attrStyleShift);
+    }
+
+    /**
+     * @brief Print formatted string to the specified position of the display
+     * Only characters which differ from the ones shown on the line are sent to the screen
+     *
+     * @param charOffset Horisontal position offset from the left, characters
+     * @param line Vertical line identifier
+     * @param format Formatted string
+     * @param args Parameters for formatted string
+     * @param isFormatInFlash true if formatted string is in program memory, false if in RAM
+     */
+    void print(uint8_t charOffset, Line line, const char *format, va_list args, bool isFormatInFlash)
+    {
+        if (line >= Line::Count)
+        {
+            return;
+        }
+
+        uint8_t xPos = 0;
+        uint8_t yPos = lineOffsets[(uint8_t)line];
+
+        if (line == Line::Header)
+        {
+            Display::setStyle(Display::Style::Bold);
+            Display::setSize(Display::Size::Font_8x16);
+            xPos = headerOffsetXPix;
+        }
+        else if (line == Line::Navigation)
+        {
+            xPos = navOffsetXPix;
+        }
+        else
+        {
+            xPos = linesOffsetXPix;
+        }
+
+        if (charOffset < lengthMax)
+        {
+            if (isFormatInFlash == true)
+            {
+                vsnprintf_P(buffer, lengthMax - charOffset + 1, format, args);
+            }
+            else
+            {
+                vsnprintf(buffer, lengthMax - charOffset + 1, format, args);
+            }
+
+            ShadowLine &shadow = shadowLines[(uint8_t)line];
+            if (shadow.size != sizeInUse)
+            {
+                // Cells of the other size don't match the printed ones, cleared line is blank in any size
+                if (shadow.isBlank == false)
+                {
+                    invalidateShadow(line);
+                }
+                shadow.size = sizeInUse;
+            }
+
+            uint8_t length = strlen(buffer);
+            uint8_t runStart = 0;
+            uint8_t runEnd = 0;
+            for (uint8_t idx = 0; idx <= length; idx++)
+            {
+                // Changed characters are collected in runs, each run is sent at once
+                bool isChanged = false;
+                if (idx < length)
+                {
+                    uint8_t cellIdx = charOffset + idx;
+                    uint8_t attrs = getCellAttrs(buffer[idx]);
+                    isChanged = (shadow.chars[cellIdx] != buffer[idx] || shadow.attrs[cellIdx] != attrs);
+                    shadow.chars[cellIdx] = buffer[idx];
+                    shadow.attrs[cellIdx] = attrs;
+                }
+
+                if (isChanged == true && runEnd > runStart && idx - runEnd <= runGapMax)
+                {
+                    runEnd = idx + 1;
+                }
+                else if (isChanged == true || idx == length)
+                {
+                    if (runEnd > runStart)
+                    {
+                        char nextChar = buffer[runEnd];
+                        buffer[runEnd] = '\0';
+                        Hal::Screen::print(xPos + (charOffset + runStart) * charWidthPix, yPos, &buffer[runStart],
+                                           fontStyle);
+                        buffer[runEnd] = nextChar;
+                    }
+                    runStart = idx;
+                    runEnd = (isChanged == true) ? idx + 1 : idx;
+                }
+            }
+
+            if (length > 0)
+            {
+                shadow.isBlank = false;
+                // Large font of a text line covers the next line as well, small font of the next
+                // line overwrites the lower half of the large one
+                uint8_t lineIdx = (uint8_t)line;
+                if (line != Line::Header && sizeInUse == Size::Font_8x16 && lineIdx + 1 < (uint8_t)Line::Count)
+                {
+                    invalidateShadow((Line)(lineIdx + 1));
+                }
+                else if (lineIdx > (uint8_t)Line::Line_1 && shadowLines[lineIdx - 1].size == Size::Font_8x16)
+                {
+                    invalidateShadow((Line)(lineIdx - 1));
+                }
+            }
+        }
+
+        if (isInvertedInUse != isInvertedPermanent)
+        {
+            // Return permanent inverted mode in use
+            setInverted(isInvertedPermanent);
+        }
+
+        if (styleInUse != stylePermanent)
+        {
+            // Return permament style back in use
+            setStyle(stylePermanent);
+        }
+
+        if (sizeInUse != sizePermanent)
+        {
+            // Return permament size back in use
+            setSize(sizePermanent);
+        }
+    }
 } // namespace
 
 /**
@@ -48,9 +244,9 @@ namespace
  */
 void Display::initialize()
 {
-    ssd1306_128x64_i2c_init();
-    ssd1306_clearScreen();
-    ssd1306_setFixedFont(ssd1306xled_font6x8);
+    Hal::Screen::initialize();
+    Display::clear();
+    Hal::Screen::setFont(Hal::Screen::Font::Font_6x8);
 }
 
 /**
@@ -59,19 +255,12 @@ void Display::initialize()
  * @param isInverted true for inverted mode, false for normal
  * @param isPermanent true if set mode is permament, false if temporary
  */
-void Display::setInverted(bool isInverted, bool isPermanent = false)
+void Display::setInverted(bool isInverted, bool isPermanent)
 {
     if (isInvertedInUse != isInverted)
     {
         isInvertedInUse = isInverted;
-        if (isInvertedInUse == true)
-        {
-            ssd1306_negativeMode();
-        }
-        else
-        {
-            ssd1306_positiveMode();
-        }
+        Hal::Screen::setInverted(isInvertedInUse);
     }
 
     if (isPermanent == true && isInvertedPermanent != isInverted)
@@ -94,20 +283,20 @@ void Display::setStyle(Style style, bool isPermanent)
         switch (styleInUse)
         {
         case Style::Normal:
-            fontStyle = STYLE_NORMAL;
+            fontStyle = Hal::Screen::Style::Normal;
             break;
 
         case Style::Bold:
-            fontStyle = STYLE_BOLD;
+            fontStyle = Hal::Screen::Style::Bold;
             break;
 
         case Style::Italic:
-            fontStyle = STYLE_ITALIC;
+            fontStyle = Hal::Screen::Style::Italic;
             break;
 
         default:
             styleInUse = Style::Normal;
-            fontStyle = STYLE_NORMAL;
+            fontStyle = Hal::Screen::Style::Normal;
             break;
         }
     }
@@ -132,20 +321,20 @@ void Display::setSize(Size size, bool isPermanent)
         switch (sizeInUse)
         {
         case Size::Font_6x8:
-            ssd1306_setFixedFont(ssd1306xled_font6x8);
+            Hal::Screen::setFont(Hal::Screen::Font::Font_6x8);
             charWidthPix = textSize6x8CharWidthPix;
             lengthMax = textSize6x8LengthMax;
             break;
 
         case Size::Font_8x16:
-            ssd1306_setFixedFont(ssd1306xled_font8x16);
+            Hal::Screen::setFont(Hal::Screen::Font::Font_8x16);
             charWidthPix = textSize8x16CharWidthPix;
             lengthMax = textSize8x16LengthMax;
             break;
 
         default:
             sizeInUse = Size::Font_6x8;
-            ssd1306_setFixedFont(ssd1306xled_font6x8);
+            Hal::Screen::setFont(Hal::Screen::Font::Font_6x8);
             charWidthPix = textSize6x8CharWidthPix;
             lengthMax = textSize6x8LengthMax;
             break;
@@ -160,6 +349,7 @@ void Display::setSize(Size size, bool isPermanent)
 
 /**
  * @brief Print formatted string to the specified position of the display
+ * Only characters which differ from the ones shown on the line are sent to the screen
  *
  * @param charOffset Horisontal position offset from the left, characters
  * @param line Vertical line identifier
@@ -168,60 +358,48 @@ void Display::setSize(Size size, bool isPermanent)
  */
 void Display::printf(uint8_t charOffset, Line line, const char *format, ...)
 {
-    if (charOffset >= lengthMax || line >= Line::Count)
-    {
-        return;
-    }
-
     va_list args;
 
     va_start(args, format);
-    vsnprintf(buffer, lengthMax + 1, format, args);
+    print(charOffset, line, format, args, false);
     va_end(args);
+}
 
-    uint8_t xPos = charOffset * charWidthPix;
-    uint8_t yPos = lineOffsets[(uint8_t)line];
-
-    if (line == Line::Header)
-    {
-        Display::setStyle(Display::Style::Bold);
-        Display::setSize(Display::Size::Font_8x16);
-        xPos += headerOffsetXPix;
-    }
-    else if (line == Line::Navigation)
-    {
-        xPos += navOffsetXPix;
-    }
-    else
-    {
-        xPos += linesOffsetXPix;
-    }
-
-    ssd1306_printFixed(xPos, yPos, buffer, fontStyle);
+/**
+ * @brief Print formatted string stored in program memory to the specified position of the display
+ *
+ * @param charOffset Horisontal position offset from the left, characters
+ * @param line Vertical line identifier
+ * @param format Formatted string in program memory, F() macro
+ * @param ... Parameters for formatted string
+ */
+void Display::printf(uint8_t charOffset, Line line, const __FlashStringHelper *format, ...)
+{
+    va_list args;
 
-    if (isInvertedInUse != isInvertedPermanent)
-    {
-        // Return permanent inverted mode in use
-        setInverted(isInvertedPermanent);
-    }
+    va_start(args, format);
+    print(charOffset, line, reinterpret_cast<const char *>(format), args, true);
+    va_end(args);
+}
 
-    if (styleInUse != stylePermanent)
-    {
-        // Return permament style back in use
-        setStyle(stylePermanent);
-    }
+/**
+ * @brief Clear the screen
+ */
+void Display::clear()
+{
+    Hal::Screen::clear();
 
-    if (sizeInUse != sizePermanent)
+    for (uint8_t lineIdx = 0; lineIdx < (uint8_t)Line::Count; lineIdx++)
     {
-        // Return permament size back in use
-        setSize(sizePermanent);
+        resetShadow((Line)lineIdx);
     }
 }
 
 /**
- * @brief Clear the screen
+ * @brief Wait until the screen shows everything printed before
+ * Printing returns once the text is queued, the screen is updated in the background
  */
-void Display::clear()
+void Display::flush()
 {
-    ssd1306_clearScreen();
+    Hal::Screen::flush();
 }
@@ -3,6 +3,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+class __FlashStringHelper;
+
 namespace Display
 {
   /**
@@ -78,8 +80,24 @@ namespace Display
    */
   void printf(uint8_t charOffset, Line line, const char *format, ...);
 
+  /**
+   * @brief Print formatted string stored in program memory to the specified position of the display
+   *
+   * @param charOffset Horisontal position offset from the left, characters
+   * @param line Vertical line identifier
+   * @param format Formatted string in program memory, F() macro
+   * @param ... Parameters for formatted string
+   */
+  void printf(uint8_t charOffset, Line line, const __FlashStringHelper *format, ...);
+
   /**
    * @brief Clear the screen
    */
   void clear();
+
+  /**
+   * @brief Wait until the screen shows everything printed before
+   * Printing returns once the text is queued, the screen is updated in the background
+   */
+  void flush();
 } // namespace Display
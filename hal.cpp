@@ -0,0 +1,775 @@
+#include "hal.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <SPI.h>
+#include <intf/ssd1306_interface.h>
+#include <lcd/oled_ssd1306.h>
+#include <ssd1306.h>
+#include <util/twi.h>
+
+// #define PROFILE_REPORT // Uncomment to print measured times to the serial port
+
+using namespace Hal;
+
+namespace
+{
+    // EEPROM ready interrupt handler
+    void (*volatile eepromReadyHandler)() = nullptr;
+    // Timer compare interrupt handler
+    void (*volatile timerHandler)() = nullptr;
+    // Timer1 ticks per microsecond at clk/8 prescaler
+    constexpr uint8_t timerTicksPerUs = F_CPU / 8 / 1000000;
+    static_assert(timerTicksPerUs == Timer::ticksPerUs);
+    static_assert((unsigned long)Timer::delayMaxUs * timerTicksPerUs <= UINT16_MAX);
+    // Timer1 counter value of the event being handled
+    uint16_t timerEventTicks = 0;
+
+    uint8_t txPin = 0;
+
+    // SSD1306 address on the I2C bus
+    constexpr uint8_t screenAddress = 0x3C;
+    // I2C fast mode clock, Hz
+    constexpr unsigned long twiClockHz = 400000;
+    // TWI control value to continue the transfer with the interrupt enabled
+    constexpr uint8_t twiControlNext = _BV(TWEN) | _BV(TWIE) | _BV(TWINT);
+
+    /**
+     * @brief TWI transfer queue states
+     */
+    enum class TwiState : uint8_t
+    {
+        Idle,     // Bus is free, all queued bytes are sent
+        Sending,  // Interrupt sends the queued bytes
+        Waiting,  // Next byte of the open transfer is not queued yet, bus is held
+        Dropping, // Screen didn't acknowledge, rest of the open transfer is dropped
+    };
+
+    constexpr uint8_t twiQueueMask = Screen::queueSize - 1;
+    static_assert((Screen::queueSize & twiQueueMask) == 0);
+    // Number of closed transfers queued at once
+    constexpr uint8_t twiEndsSize = 8;
+    constexpr uint8_t twiEndsMask = twiEndsSize - 1;
+
+    uint8_t twiQueue[Screen::queueSize];
+    // Next byte sent by the interrupt and next free byte of the queue
+    volatile uint8_t twiHead = 0;
+    volatile uint8_t twiTail = 0;
+    // Queue positions after the last byte of every closed transfer
+    uint8_t twiEnds[twiEndsSize];
+    volatile uint8_t twiEndsHead = 0;
+    volatile uint8_t twiEndsTail = 0;
+    volatile TwiState twiState = TwiState::Idle;
+
+    /**
+     * @brief Continue sending the queued bytes, called from the TWI interrupt
+     */
+    void twiSendNext()
+    {
+        if (twiEndsHead != twiEndsTail && twiHead == twiEnds[twiEndsHead])
+        {
+            // Transfer is complete, the next one starts right after the stop
+            twiEndsHead = (twiEndsHead + 1) & twiEndsMask;
+            if (twiHead != twiTail)
+            {
+                TWCR = twiControlNext | _BV(TWSTO) | _BV(TWSTA);
+            }
+            else
+            {
+                TWCR = _BV(TWEN) | _BV(TWINT) | _BV(TWSTO);
+                twiState = TwiState::Idle;
+            }
+        }
+        else if (twiHead != twiTail)
+        {
+            TWDR = twiQueue[twiHead];
+            twiHead = (twiHead + 1) & twiQueueMask;
+            TWCR = twiControlNext;
+        }
+        else
+        {
+            // Interrupt flag stays set and holds the bus until the next byte is queued
+            TWCR = _BV(TWEN);
+            twiState = TwiState::Waiting;
+        }
+    }
+
+    /**
+     * @brief Start sending the byte just queued
+     * Interrupts should be disabled
+     */
+    void twiResume()
+    {
+        if (twiState == TwiState::Idle)
+        {
+            // Stop of the previous transfer should be complete before the start
+            while ((TWCR & _BV(TWSTO)) != 0)
+            {
+            }
+            TWCR = twiControlNext | _BV(TWSTA);
+            twiState = TwiState::Sending;
+        }
+        else if (twiState == TwiState::Waiting)
+        {
+            // Interrupt flag is still set, the interrupt fires right away
+            TWCR = _BV(TWEN) | _BV(TWIE);
+            twiState = TwiState::Sending;
+        }
+    }
+
+    /**
+     * @brief Start screen transfer, nothing is sent until its first byte is queued
+     */
+    void twiStart()
+    {
+    }
+
+    /**
+     * @brief Queue byte of the screen transfer, wait while the queue is full
+     *
+     * @param data Byte to send
+     */
+    void twiSend(uint8_t data)
+    {
+        uint8_t next = (twiTail + 1) & twiQueueMask;
+        while (next == twiHead)
+        {
+        }
+
+        uint8_t state = Interrupts::lock();
+        if (twiState != TwiState::Dropping)
+        {
+            twiQueue[twiTail] = data;
+            twiTail = next;
+            twiResume();
+        }
+        Interrupts::restore(state);
+    }
+
+    /**
+     * @brief Queue bytes of the screen transfer
+     *
+     * @param buffer Bytes to send
+     * @param size Number of bytes
+     */
+    void twiSendBuffer(const uint8_t *buffer, uint16_t size)
+    {
+        while (size-- > 0)
+        {
+            twiSend(*buffer++);
+        }
+    }
+
+    /**
+     * @brief Close screen transfer, the interrupt stops it after its last byte
+     * Queue stays idle for the transfer with no bytes, there is nothing to stop
+     */
+    void twiStop()
+    {
+        uint8_t state = Interrupts::lock();
+        if (twiState == TwiState::Dropping)
+        {
+            twiState = TwiState::Idle;
+        }
+        else if (twiState != TwiState::Idle)
+        {
+            uint8_t next = (twiEndsTail + 1) & twiEndsMask;
+            while (next == twiEndsHead)
+            {
+                // Let the interrupt complete the oldest transfer
+                Interrupts::restore(state);
+                state = Interrupts::lock();
+            }
+            twiEnds[twiEndsTail] = twiTail;
+            twiEndsTail = next;
+            if (twiState == TwiState::Waiting)
+            {
+                twiResume();
+            }
+        }
+        Interrupts::restore(state);
+    }
+
+    /**
+     * @brief Close screen interface
+     */
+    void twiClose()
+    {
+    }
+} // namespace
+
+/**
+ * @brief EEPROM ready interrupt
+ */
+ISR(EE_READY_vect)
+{
+    if (eepromReadyHandler != nullptr)
+    {
+        eepromReadyHandler();
+    }
+}
+
+/**
+ * @brief TWI interrupt, sends the screen transfer queue
+ */
+ISR(TWI_vect)
+{
+    switch (TW_STATUS)
+    {
+    case TW_START:
+    case TW_REP_START:
+        TWDR = (screenAddress << 1) | TW_WRITE;
+        TWCR = twiControlNext;
+        break;
+
+    case TW_MT_SLA_ACK:
+    case TW_MT_DATA_ACK:
+        twiSendNext();
+        break;
+
+    default:
+        // Screen didn't acknowledge or the bus is lost, rest of the transfer is dropped
+        if (twiEndsHead != twiEndsTail)
+        {
+            twiHead = twiEnds[twiEndsHead];
+            twiSendNext();
+        }
+        else
+        {
+            twiHead = twiTail;
+            TWCR = _BV(TWEN) | _BV(TWINT) | _BV(TWSTO);
+            twiState = TwiState::Dropping;
+        }
+        break;
+    }
+}
+
+/**
+ * @brief Timer1 compare B interrupt
+ */
+ISR(TIMER1_COMPB_vect)
+{
+    timerEventTicks = OCR1B;
+    if (timerHandler != nullptr)
+    {
+        timerHandler();
+    }
+}
+
+/**
+ * @brief Return time since startup
+ *
+ * @return Time, milliseconds
+ */
+unsigned long Hal::Clock::millis()
+{
+    return ::millis();
+}
+
+/**
+ * @brief Return time since startup
+ *
+ * @return Time, microseconds
+ */
+unsigned long Hal::Clock::micros()
+{
+    return ::micros();
+}
+
+/**
+ * @brief Wait for specified time
+ *
+ * @param timeMs Time to wait, milliseconds
+ */
+void Hal::Clock::delay(unsigned long timeMs)
+{
+    ::delay(timeMs);
+}
+
+/**
+ * @brief Wait for specified short time
+ *
+ * @param timeUs Time to wait, microseconds
+ */
+void Hal::Clock::delayMicroseconds(uint16_t timeUs)
+{
+    ::delayMicroseconds(timeUs);
+}
+
+/**
+ * @brief Disable interrupts to enter critical section
+ *
+ * @return Previous interrupts state to restore
+ */
+uint8_t Hal::Interrupts::lock()
+{
+    uint8_t state = SREG;
+    cli();
+    return state;
+}
+
+/**
+ * @brief Restore interrupts state to leave critical section
+ *
+ * @param state Interrupts state returned by lock()
+ */
+void Hal::Interrupts::restore(uint8_t state)
+{
+    SREG = state;
+}
+
+/**
+ * @brief Set timer interrupt handler, counter runs free from now
+ * Timer1 is switched from the Arduino PWM mode to the normal mode at clk/8
+ *
+ * @param handler Function called from the interrupt on every timer event
+ */
+void Hal::Timer::setHandler(void (*handler)())
+{
+    uint8_t state = Interrupts::lock();
+    timerHandler = handler;
+    TCCR1A = 0;
+    TCCR1B = _BV(CS11);
+    Interrupts::restore(state);
+}
+
+/**
+ * @brief Return free running counter value
+ * Cheap time source for interrupt handlers, differences of two values are valid
+ * for intervals shorter than the counter wrap
+ * Should be called with interrupts disabled, Timer1 16-bit registers share the TEMP register
+ *
+ * @return Counter value, ticks
+ */
+uint16_t Hal::Timer::getTicks()
+{
+    return TCNT1;
+}
+
+/**
+ * @brief Start timer, the first event fires after the delay
+ * Timer1 runs free at clk/8, events are set by the compare B register which also drives OC1B pin
+ *
+ * @param delayUs Delay from now, microseconds (up to delayMaxUs)
+ */
+void Hal::Timer::start(uint16_t delayUs)
+{
+    uint8_t state = Interrupts::lock();
+    TCCR1A = 0;
+    OCR1B = TCNT1 + delayUs * timerTicksPerUs;
+    TIFR1 = _BV(OCF1B);
+    TIMSK1 |= _BV(OCIE1B);
+    Interrupts::restore(state);
+}
+
+/**
+ * @brief Schedule the next event relative to the current one
+ * Should be called from the handler on every event until the timer is stopped,
+ * events don't drift by the handler execution time
+ *
+ * @param delayUs Delay from the current event, microseconds (up to delayMaxUs)
+ * @return true if event is scheduled in time, false if its time has already passed
+ *         and it fires right away
+ */
+bool Hal::Timer::scheduleNext(uint16_t delayUs)
+{
+    uint16_t delayTicks = delayUs * timerTicksPerUs;
+    OCR1B = timerEventTicks + delayTicks;
+
+    // Compare doesn't match until the counter wraps if the handler came too late,
+    // event is moved a couple of microseconds ahead instead
+    if ((uint16_t)(TCNT1 - timerEventTicks) >= delayTicks)
+    {
+        OCR1B = TCNT1 + 2 * timerTicksPerUs;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Set level of the output pin at the next event
+ * Compare match sets or clears OC1B, pin level doesn't depend on the interrupt latency
+ *
+ * @param level Gpio::levelHigh or Gpio::levelLow
+ */
+void Hal::Timer::setOutputLevel(uint8_t level)
+{
+    TCCR1A = (level == Gpio::levelHigh) ? (_BV(COM1B1) | _BV(COM1B0)) : _BV(COM1B1);
+}
+
+/**
+ * @brief Return time since the current event
+ *
+ * @return Elapsed time, microseconds
+ */
+uint16_t Hal::Timer::getElapsedUs()
+{
+    return (uint16_t)(TCNT1 - timerEventTicks) / timerTicksPerUs;
+}
+
+/**
+ * @brief Stop timer, no more events fire
+ * Output pin is set low and released to the Gpio control
+ */
+void Hal::Timer::stop()
+{
+    TIMSK1 &= ~_BV(OCIE1B);
+    if (TCCR1A != 0)
+    {
+        // Force OC1B low, so the next start doesn't connect the pin at high level
+        TCCR1A = _BV(COM1B1);
+        TCCR1C = _BV(FOC1B);
+        TCCR1A = 0;
+    }
+}
+
+/**
+ * @brief Report measured time of the operation
+ *
+ * @param name Operation name in program memory
+ * @param timeUs Measured time, microseconds
+ */
+void Hal::Profile::report(const __FlashStringHelper *name, unsigned long timeUs)
+{
+#ifdef PROFILE_REPORT
+    char buffer[40];
+    snprintf_P(buffer, sizeof(buffer), PSTR("%S: %lu us"), reinterpret_cast<const char *>(name), timeUs);
+    ::Serial.println(buffer);
+#endif // PROFILE_REPORT
+}
+
+/**
+ * @brief Set pin mode
+ *
+ * @param pin Pin number
+ * @param mode New pin mode
+ */
+void Hal::Gpio::setMode(uint8_t pin, Mode mode)
+{
+    switch (mode)
+    {
+    case Mode::InputPullup:
+        pinMode(pin, INPUT_PULLUP);
+        break;
+
+    case Mode::Output:
+        pinMode(pin, OUTPUT);
+        break;
+
+    case Mode::Input:
+    default:
+        pinMode(pin, INPUT);
+        break;
+    }
+}
+
+/**
+ * @brief Read digital pin level
+ *
+ * @param pin Pin number
+ * @return Current pin level
+ */
+uint8_t Hal::Gpio::read(uint8_t pin)
+{
+    return (digitalRead(pin) == HIGH) ? levelHigh : levelLow;
+}
+
+/**
+ * @brief Return port input register and bit of the pin
+ *
+ * @param pin Pin number
+ * @return Port pin to read with readPort()
+ */
+Hal::Gpio::PortPin Hal::Gpio::getPortPin(uint8_t pin)
+{
+    return {portInputRegister(digitalPinToPort(pin)), digitalPinToBitMask(pin)};
+}
+
+/**
+ * @brief Set digital output pin level
+ *
+ * @param pin Pin number
+ * @param level New pin level
+ */
+void Hal::Gpio::write(uint8_t pin, uint8_t level)
+{
+    digitalWrite(pin, (level == levelHigh) ? HIGH : LOW);
+}
+
+/**
+ * @brief Attach handler to the external interrupt, it fires on every level change
+ *
+ * @param interrupt External interrupt number
+ * @param handler Function called from the interrupt
+ */
+void Hal::Gpio::attachInterrupt(uint8_t interrupt, void (*handler)())
+{
+    ::attachInterrupt(interrupt, handler, CHANGE);
+}
+
+/**
+ * @brief Detach handler from the external interrupt
+ *
+ * @param interrupt External interrupt number
+ */
+void Hal::Gpio::detachInterrupt(uint8_t interrupt)
+{
+    ::detachInterrupt(interrupt);
+}
+
+/**
+ * @brief Read analog pin value
+ *
+ * @param pin Pin number
+ * @return Raw ADC value
+ */
+uint16_t Hal::Gpio::readAnalog(uint8_t pin)
+{
+    return analogRead(pin);
+}
+
+/**
+ * @brief Initialize serial port
+ *
+ * @param baudRate Serial port baud rate
+ */
+void Hal::Serial::initialize(unsigned long baudRate)
+{
+    ::Serial.begin(baudRate);
+}
+
+/**
+ * @brief Print text line to the serial port
+ *
+ * @param text Null-terminated string
+ */
+void Hal::Serial::println(const char *text)
+{
+    ::Serial.println(text);
+}
+
+/**
+ * @brief Initialize SPI master, mode 0, MSB first
+ *
+ * @param clockHz Maximum clock frequency, Hz
+ */
+void Hal::Spi::initialize(unsigned long clockHz)
+{
+    SPI.begin();
+    SPI.beginTransaction(SPISettings(clockHz, MSBFIRST, SPI_MODE0));
+}
+
+/**
+ * @brief Exchange one byte
+ *
+ * @param value Byte to send
+ * @return Received byte
+ */
+uint8_t Hal::Spi::transfer(uint8_t value)
+{
+    return SPI.transfer(value);
+}
+
+/**
+ * @brief Read byte from EEPROM
+ *
+ * @param address Byte address
+ * @return Stored byte value
+ */
+uint8_t Hal::Eeprom::read(int address)
+{
+    return EEPROM.read(address);
+}
+
+/**
+ * @brief Write byte to EEPROM
+ *
+ * @param address Byte address
+ * @param value New byte value
+ */
+void Hal::Eeprom::write(int address, uint8_t value)
+{
+    EEPROM.write(address, value);
+}
+
+/**
+ * @brief Check if EEPROM is ready for the next write
+ *
+ * @return true if no write is in progress, false otherwise
+ */
+bool Hal::Eeprom::isReady()
+{
+    return (EECR & _BV(EEPE)) == 0;
+}
+
+/**
+ * @brief Start byte write and return without waiting for its completion
+ * EEPROM should be ready
+ *
+ * @param address Byte address
+ * @param value New byte value
+ */
+void Hal::Eeprom::startWrite(int address, uint8_t value)
+{
+    uint8_t state = Interrupts::lock();
+
+    EEAR = address;
+    EEDR = value;
+    // Erase and write in one operation, EEPE should be set within 4 cycles after EEMPE
+    EECR |= _BV(EEMPE);
+    EECR |= _BV(EEPE);
+
+    Interrupts::restore(state);
+}
+
+/**
+ * @brief Set EEPROM ready interrupt handler
+ *
+ * @param handler Function called from the interrupt while it is enabled
+ */
+void Hal::Eeprom::setReadyHandler(void (*handler)())
+{
+    eepromReadyHandler = handler;
+}
+
+/**
+ * @brief Enable or disable EEPROM ready interrupt
+ * Interrupt fires continuously while EEPROM is ready and interrupt is enabled
+ *
+ * @param isEnabled true to enable interrupt, false to disable
+ */
+void Hal::Eeprom::enableReadyInterrupt(bool isEnabled)
+{
+    if (isEnabled == true)
+    {
+        EECR |= _BV(EERIE);
+    }
+    else
+    {
+        EECR &= ~_BV(EERIE);
+    }
+}
+
+/**
+ * @brief Initialize 128x64 screen
+ */
+void Hal::Screen::initialize()
+{
+    // Pull-ups on SDA and SCL, bit rate without prescaler
+    PORTC |= _BV(PORTC4) | _BV(PORTC5);
+    TWSR = 0;
+    TWBR = (F_CPU / twiClockHz - 16) / 2;
+    TWCR = _BV(TWEN);
+
+    // Library sends through the queue instead of its blocking I2C interface
+    ssd1306_intf.spi = 0;
+    ssd1306_intf.start = twiStart;
+    ssd1306_intf.stop = twiStop;
+    ssd1306_intf.send = twiSend;
+    ssd1306_intf.send_buffer = twiSendBuffer;
+    ssd1306_intf.close = twiClose;
+    ssd1306_128x64_init();
+}
+
+/**
+ * @brief Clear the screen
+ */
+void Hal::Screen::clear()
+{
+    ssd1306_clearScreen();
+}
+
+/**
+ * @brief Set fixed font for printed text
+ *
+ * @param font New font
+ */
+void Hal::Screen::setFont(Font font)
+{
+    if (font == Font::Font_8x16)
+    {
+        ssd1306_setFixedFont(ssd1306xled_font8x16);
+    }
+    else
+    {
+        ssd1306_setFixedFont(ssd1306xled_font6x8);
+    }
+}
+
+/**
+ * @brief Set inverted mode for printed text
+ *
+ * @param isInverted true for inverted mode, false for normal
+ */
+void Hal::Screen::setInverted(bool isInverted)
+{
+    if (isInverted == true)
+    {
+        ssd1306_negativeMode();
+    }
+    else
+    {
+        ssd1306_positiveMode();
+    }
+}
+
+/**
+ * @brief Print text at specified position
+ *
+ * @param xPos Horizontal position, pixels
+ * @param yPos Vertical position, pixels (multiple of 8)
+ * @param text Null-terminated string
+ * @param style Font style
+ */
+void Hal::Screen::print(uint8_t xPos, uint8_t yPos, const char *text, Style style)
+{
+    EFontStyle fontStyle = STYLE_NORMAL;
+    if (style == Style::Bold)
+    {
+        fontStyle = STYLE_BOLD;
+    }
+    else if (style == Style::Italic)
+    {
+        fontStyle = STYLE_ITALIC;
+    }
+
+    ssd1306_printFixed(xPos, yPos, text, fontStyle);
+}
+
+/**
+ * @brief Wait until all queued transfers are sent to the screen
+ */
+void Hal::Screen::flush()
+{
+    while (twiState != TwiState::Idle)
+    {
+    }
+}
+
+/**
+ * @brief Enable transmitter on specified pin, carrier is off
+ *
+ * @param pin TX pin number
+ */
+void Hal::Rf::enableTransmit(uint8_t pin)
+{
+    txPin = pin;
+    pinMode(txPin, OUTPUT);
+    digitalWrite(txPin, LOW);
+}
+
+/**
+ * @brief Set transmitter carrier level
+ * Safe to call from the interrupt
+ *
+ * @param level Gpio::levelHigh to turn carrier on, Gpio::levelLow to turn it off
+ */
+void Hal::Rf::setTransmitLevel(uint8_t level)
+{
+    digitalWrite(txPin, (level == Gpio::levelHigh) ? HIGH : LOW);
+}
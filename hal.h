@@ -0,0 +1,466 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(ARDUINO)
+#include <WString.h>
+#include <avr/pgmspace.h>
+#else
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+// Program memory is the same address space as RAM on the host
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t *)(address))
+#define memcpy_P memcpy
+#define strncpy_P strncpy
+// avr-libc prints a string in program memory with %S, it is %s on the host
+int vsnprintf_P(char *buffer, size_t size, const char *format, va_list args);
+int snprintf_P(char *buffer, size_t size, const char *format, ...);
+// String literals in program memory are kept in their own section, so their size can be reported
+#define PSTR(string) (__extension__({ static const char pstr[] __attribute__((section(".progmem.str"))) = (string); &pstr[0]; }))
+// Flash string type of the Arduino core
+class __FlashStringHelper;
+#define F(string) (reinterpret_cast<const __FlashStringHelper *>(PSTR(string)))
+#endif
+
+/**
+ * Hardware abstraction layer
+ *
+ * Every access to the Arduino core and external libraries goes through this interface.
+ * hal.cpp implements it for the target board, sim/hal_sim.cpp for the host simulator.
+ */
+namespace Hal
+{
+    namespace Clock
+    {
+        /**
+         * @brief Return time since startup
+         *
+         * @return Time, milliseconds
+         */
+        unsigned long millis();
+
+        /**
+         * @brief Return time since startup
+         *
+         * @return Time, microseconds
+         */
+        unsigned long micros();
+
+        /**
+         * @brief Wait for specified time
+         *
+         * @param timeMs Time to wait, milliseconds
+         */
+        void delay(unsigned long timeMs);
+
+        /**
+         * @brief Wait for specified short time
+         *
+         * @param timeUs Time to wait, microseconds
+         */
+        void delayMicroseconds(uint16_t timeUs);
+    } // namespace Clock
+
+    namespace Interrupts
+    {
+        /**
+         * @brief Disable interrupts to enter critical section
+         *
+         * @return Previous interrupts state to restore
+         */
+        uint8_t lock();
+
+        /**
+         * @brief Restore interrupts state to leave critical section
+         *
+         * @param state Interrupts state returned by lock()
+         */
+        void restore(uint8_t state);
+    } // namespace Interrupts
+
+    namespace Timer
+    {
+        // Maximum delay between two timer events, microseconds
+        static constexpr uint16_t delayMaxUs = 32000;
+        // Pin switched by the timer hardware (OC1B), its level changes exactly at the event time
+        static constexpr uint8_t outputPin = 10;
+        // Counter ticks per microsecond, counter wraps every 65536 ticks
+        static constexpr uint8_t ticksPerUs = 2;
+
+        /**
+         * @brief Set timer interrupt handler, counter runs free from now
+         *
+         * @param handler Function called from the interrupt on every timer event
+         */
+        void setHandler(void (*handler)());
+
+        /**
+         * @brief Return free running counter value
+         * Cheap time source for interrupt handlers, differences of two values are valid
+         * for intervals shorter than the counter wrap
+         * Should be called with interrupts disabled
+         *
+         * @return Counter value, ticks
+         */
+        uint16_t getTicks();
+
+        /**
+         * @brief Start timer, the first event fires after the delay
+         *
+         * @param delayUs Delay from now, microseconds (up to delayMaxUs)
+         */
+        void start(uint16_t delayUs);
+
+        /**
+         * @brief Schedule the next event relative to the current one
+         * Should be called from the handler on every event until the timer is stopped,
+         * events don't drift by the handler execution time
+         *
+         * @param delayUs Delay from the current event, microseconds (up to delayMaxUs)
+         * @return true if event is scheduled in time, false if its time has already passed
+         *         and it fires right away
+         */
+        bool scheduleNext(uint16_t delayUs);
+
+        /**
+         * @brief Set level of the output pin at the next event
+         * Should be called from the handler, output pin is driven by the timer until stop() is called
+         *
+         * @param level Gpio::levelHigh or Gpio::levelLow
+         */
+        void setOutputLevel(uint8_t level);
+
+        /**
+         * @brief Return time since the current event
+         * Should be called from the handler
+         *
+         * @return Elapsed time, microseconds
+         */
+        uint16_t getElapsedUs();
+
+        /**
+         * @brief Stop timer, no more events fire
+         * Output pin is set low and released to the Gpio control
+         */
+        void stop();
+    } // namespace Timer
+
+    namespace Profile
+    {
+        /**
+         * @brief Report measured time of the operation
+         *
+         * @param name Operation name in program memory
+         * @param timeUs Measured time, microseconds
+         */
+        void report(const __FlashStringHelper *name, unsigned long timeUs);
+    } // namespace Profile
+
+    namespace Gpio
+    {
+        // Pin levels
+        static constexpr uint8_t levelLow = 0;
+        static constexpr uint8_t levelHigh = 1;
+
+        // Analog input pins
+        static constexpr uint8_t pinA0 = 14;
+
+        /**
+         * @brief Pin modes
+         */
+        enum class Mode
+        {
+            Input,
+            InputPullup,
+            Output,
+        };
+
+        /**
+         * @brief Port input register and bit of the pin
+         */
+        struct PortPin
+        {
+            // Port input register
+            const volatile uint8_t *input;
+            // Bit mask of the pin in the register
+            uint8_t mask;
+        };
+
+        /**
+         * @brief Set pin mode
+         *
+         * @param pin Pin number
+         * @param mode New pin mode
+         */
+        void setMode(uint8_t pin, Mode mode);
+
+        /**
+         * @brief Read digital pin level
+         *
+         * @param pin Pin number
+         * @return Current pin level
+         */
+        uint8_t read(uint8_t pin);
+
+        /**
+         * @brief Return port input register and bit of the pin
+         *
+         * @param pin Pin number
+         * @return Port pin to read with readPort()
+         */
+        PortPin getPortPin(uint8_t pin);
+
+        /**
+         * @brief Read digital pin level straight from the port register
+         * Cheap pin read for interrupt handlers, the pin number is looked up once by getPortPin()
+         *
+         * @param portPin Port pin
+         * @return Current pin level
+         */
+        inline uint8_t readPort(const PortPin &portPin)
+        {
+            return ((*portPin.input & portPin.mask) != 0) ? levelHigh : levelLow;
+        }
+
+        /**
+         * @brief Set digital output pin level
+         *
+         * @param pin Pin number
+         * @param level New pin level
+         */
+        void write(uint8_t pin, uint8_t level);
+
+        /**
+         * @brief Attach handler to the external interrupt, it fires on every level change
+         *
+         * @param interrupt External interrupt number
+         * @param handler Function called from the interrupt
+         */
+        void attachInterrupt(uint8_t interrupt, void (*handler)());
+
+        /**
+         * @brief Detach handler from the external interrupt
+         *
+         * @param interrupt External interrupt number
+         */
+        void detachInterrupt(uint8_t interrupt);
+
+        /**
+         * @brief Read analog pin value
+         *
+         * @param pin Pin number
+         * @return Raw ADC value
+         */
+        uint16_t readAnalog(uint8_t pin);
+    } // namespace Gpio
+
+    namespace Serial
+    {
+        /**
+         * @brief Initialize serial port
+         *
+         * @param baudRate Serial port baud rate
+         */
+        void initialize(unsigned long baudRate);
+
+        /**
+         * @brief Print text line to the serial port
+         *
+         * @param text Null-terminated string
+         */
+        void println(const char *text);
+    } // namespace Serial
+
+    namespace Spi
+    {
+        /**
+         * @brief Initialize SPI master, mode 0, MSB first
+         *
+         * @param clockHz Maximum clock frequency, Hz
+         */
+        void initialize(unsigned long clockHz);
+
+        /**
+         * @brief Exchange one byte
+         *
+         * @param value Byte to send
+         * @return Received byte
+         */
+        uint8_t transfer(uint8_t value);
+    } // namespace Spi
+
+    namespace Eeprom
+    {
+        // EEPROM size of ATmega328P, bytes
+        static constexpr int size = 1024;
+
+        /**
+         * @brief Read byte from EEPROM
+         *
+         * @param address Byte address
+         * @return Stored byte value
+         */
+        uint8_t read(int address);
+
+        /**
+         * @brief Write byte to EEPROM
+         *
+         * @param address Byte address
+         * @param value New byte value
+         */
+        void write(int address, uint8_t value);
+
+        /**
+         * @brief Check if EEPROM is ready for the next write
+         *
+         * @return true if no write is in progress, false otherwise
+         */
+        bool isReady();
+
+        /**
+         * @brief Start byte write and return without waiting for its completion
+         * EEPROM should be ready
+         *
+         * @param address Byte address
+         * @param value New byte value
+         */
+        void startWrite(int address, uint8_t value);
+
+        /**
+         * @brief Set EEPROM ready interrupt handler
+         *
+         * @param handler Function called from the interrupt while it is enabled
+         */
+        void setReadyHandler(void (*handler)());
+
+        /**
+         * @brief Enable or disable EEPROM ready interrupt
+         * Interrupt fires continuously while EEPROM is ready and interrupt is enabled
+         *
+         * @param isEnabled true to enable interrupt, false to disable
+         */
+        void enableReadyInterrupt(bool isEnabled);
+
+        /**
+         * @brief Read object from EEPROM
+         *
+         * @param address Object start address
+         * @param object Object to read
+         */
+        template <typename T>
+        void get(int address, T &object)
+        {
+            uint8_t *pData = (uint8_t *)&object;
+            for (unsigned int idx = 0; idx < sizeof(T); idx++)
+            {
+                pData[idx] = read(address + idx);
+            }
+        }
+
+        /**
+         * @brief Write object to EEPROM, only changed bytes are written
+         *
+         * @param address Object start address
+         * @param object Object to write
+         */
+        template <typename T>
+        void put(int address, const T &object)
+        {
+            const uint8_t *pData = (const uint8_t *)&object;
+            for (unsigned int idx = 0; idx < sizeof(T); idx++)
+            {
+                if (read(address + idx) != pData[idx])
+                {
+                    write(address + idx, pData[idx]);
+                }
+            }
+        }
+    } // namespace Eeprom
+
+    namespace Screen
+    {
+        // Screen transfers are queued and sent by the TWI interrupt at 400 kHz, calls wait
+        // only while the queue is full, bytes
+        static constexpr uint8_t queueSize = 64;
+
+        /**
+         * @brief Fixed fonts
+         */
+        enum class Font
+        {
+            Font_6x8,
+            Font_8x16,
+        };
+
+        /**
+         * @brief Font styles
+         */
+        enum class Style
+        {
+            Normal,
+            Bold,
+            Italic,
+        };
+
+        /**
+         * @brief Initialize 128x64 screen
+         */
+        void initialize();
+
+        /**
+         * @brief Clear the screen
+         */
+        void clear();
+
+        /**
+         * @brief Set fixed font for printed text
+         *
+         * @param font New font
+         */
+        void setFont(Font font);
+
+        /**
+         * @brief Set inverted mode for printed text
+         *
+         * @param isInverted true for inverted mode, false for normal
+         */
+        void setInverted(bool isInverted);
+
+        /**
+         * @brief Print text at specified position
+         *
+         * @param xPos Horizontal position, pixels
+         * @param yPos Vertical position, pixels (multiple of 8)
+         * @param text Null-terminated string
+         * @param style Font style
+         */
+        void print(uint8_t xPos, uint8_t yPos, const char *text, Style style);
+
+        /**
+         * @brief Wait until all queued transfers are sent to the screen
+         */
+        void flush();
+    } // namespace Screen
+
+    namespace Rf
+    {
+        /**
+         * @brief Enable transmitter on specified pin, carrier is off
+         *
+         * @param pin TX pin number
+         */
+        void enableTransmit(uint8_t pin);
+
+        /**
+         * @brief Set transmitter carrier level
+         * Safe to call from the interrupt
+         *
+         * @param level Gpio::levelHigh to turn carrier on, Gpio::levelLow to turn it off
+         */
+        void setTransmitLevel(uint8_t level);
+    } // namespace Rf
+} // namespace Hal
@@ -0,0 +1,446 @@
+#include "journal.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "crc8.h"
+#include "log.h"
+#include "storage.h"
+
+// #define LOG_DEBUG // Uncomment to enable log printing
+
+using namespace Journal;
+
+namespace
+{
+    constexpr uint16_t headerMagic = 0x4B50; // "PK"
+    // 1: plain slot names, 2: packed slot names, 3: index of the latest records on the external storage
+    constexpr uint8_t formatVersion = Storage::isEeprom ? 2 : 3;
+
+    constexpr uint32_t sequenceErased = 0xFFFFFFFF;
+    constexpr uint16_t positionNone = 0xFFFF;
+
+#pragma pack(push, 1)
+    /**
+     * @brief Storage header structure
+     */
+    struct Header
+    {
+        uint16_t magic;
+        uint8_t version;
+        uint8_t recordSize;
+    };
+
+    /**
+     * @brief Journal record structure
+     */
+    struct Record
+    {
+        uint32_t sequence;
+        uint8_t key;
+        uint8_t data[dataSize];
+        uint8_t crc8;
+    };
+#pragma pack(pop)
+
+    constexpr Header header = {headerMagic, formatVersion, sizeof(Record)};
+
+    // Header is placed at the start of the first page, records of every page follow the same offset
+    constexpr uint32_t headerAddress = 0;
+    constexpr uint16_t recordsOffset = sizeof(Header);
+    constexpr uint16_t recordsPerPage = (Storage::pageSize - recordsOffset) / sizeof(Record);
+
+#ifdef STORAGE_EEPROM
+    // Position of the latest record for each key
+    uint16_t keyPositions[keysCount];
+    constexpr uint32_t indexAddress = Storage::size;
+#else
+    // Positions of the latest records of hundreds of keys don't fit the RAM, they are kept at the end
+    // of the storage instead and rebuilt by the boot scan
+    constexpr uint32_t indexAddress = Storage::size - keysCount * sizeof(uint16_t);
+#endif
+    // Records of the page holding the index end before it
+    constexpr uint16_t indexPageOffset = indexAddress % Storage::pageSize;
+    constexpr uint16_t recordsCount = indexAddress / Storage::pageSize * recordsPerPage +
+                                      ((indexPageOffset > recordsOffset) ? (indexPageOffset - recordsOffset) / sizeof(Record) : 0);
+    // At least one record should always be reclaimable
+    static_assert(recordsCount > keysCount);
+    static_assert(recordsCount < positionNone);
+
+    // Bit per key, set if CRC of the latest record is checked
+    uint8_t keysValidated[(keysCount + 7) / 8];
+#ifdef STORAGE_EEPROM
+    static_assert(sizeof(keyPositions) + sizeof(keysValidated) == indexRamSize);
+#else
+    static_assert(sizeof(keysValidated) == indexRamSize);
+#endif
+    // Position for the next record
+    uint16_t headPosition = 0;
+    // Sequence number for the next record
+    uint32_t nextSequence = 0;
+
+    /**
+     * @brief Return storage address of the record
+     *
+     * @param position Record position
+     * @return Record address
+     */
+    inline uint32_t getAddress(uint16_t position)
+    {
+        return Storage::getPageAddress(position / recordsPerPage) + recordsOffset +
+               (position % recordsPerPage) * sizeof(Record);
+    }
+
+    /**
+     * @brief Return position of the latest record of the key
+     *
+     * @param key Record key
+     * @return Record position, positionNone if key has no record
+     */
+    inline uint16_t getKeyPosition(uint8_t key)
+    {
+#ifdef STORAGE_EEPROM
+        return keyPositions[key];
+#else
+        uint16_t position;
+        Storage::get(indexAddress + key * sizeof(uint16_t), position);
+        return position;
+#endif
+    }
+
+    /**
+     * @brief Set position of the latest record of the key
+     *
+     * @param key Record key
+     * @param position Record position, positionNone if key has no record
+     */
+    inline void setKeyPosition(uint8_t key, uint16_t position)
+    {
+#ifdef STORAGE_EEPROM
+        keyPositions[key] = position;
+#else
+        Storage::put(indexAddress + key * sizeof(uint16_t), position);
+#endif
+    }
+
+    /**
+     * @brief Calculate CRC of the record
+     *
+     * @param record Record to calculate
+     * @return CRC of all record fields except CRC itself
+     */
+    inline uint8_t calcCrc(const Record &record)
+    {
+        return Crc8::calculate(&record, sizeof(Record) - sizeof(record.crc8));
+    }
+
+    /**
+     * @brief Check if the latest record of the key is validated
+     *
+     * @param key Record key
+     * @return true if record is validated, false otherwise
+     */
+    inline bool isValidated(uint8_t key)
+    {
+        return (keysValidated[key / 8] & (1 << (key % 8))) != 0;
+    }
+
+    /**
+     * @brief Mark the latest record of the key as validated
+     *
+     * @param key Record key
+     */
+    inline void setValidated(uint8_t key)
+    {
+        keysValidated[key / 8] |= (1 << (key % 8));
+    }
+
+    /**
+     * @brief Load record sequence and key only, CRC is not checked
+     *
+     * @param position Record position
+     * @param record Record to load
+     * @return true if record is written, false otherwise
+     */
+    bool loadHeader(uint16_t position, Record &record)
+    {
+        Storage::read(getAddress(position), &record, offsetof(Record, data));
+
+        return (record.sequence != sequenceErased && record.key < keysCount);
+    }
+
+    /**
+     * @brief Load record and check if it is valid
+     *
+     * @param position Record position
+     * @param record Record to load
+     * @return true if record is valid, false otherwise
+     */
+    bool load(uint16_t position, Record &record)
+    {
+        Storage::get(getAddress(position), record);
+
+        return (record.sequence != sequenceErased &&
+                record.key < keysCount &&
+                record.crc8 == calcCrc(record));
+    }
+
+    /**
+     * @brief Find the latest valid record of the key, used when the latest written one is torn
+     *
+     * @param key Record key
+     */
+    void recover(uint8_t key)
+    {
+        uint16_t keyPosition = positionNone;
+        uint32_t keySequence = 0;
+
+        for (uint16_t position = 0; position < recordsCount; position++)
+        {
+            Record record;
+            if (load(position, record) == true && record.key == key &&
+                (keyPosition == positionNone || record.sequence > keySequence))
+            {
+                keyPosition = position;
+                keySequence = record.sequence;
+            }
+        }
+
+#ifdef LOG_DEBUG
+        Log::printf(F("Journal recover key %u pos %u"), key, keyPosition);
+#endif // LOG_DEBUG
+
+        setKeyPosition(key, keyPosition);
+    }
+
+    /**
+     * @brief Validate the latest record of the key, the previous valid one is used if it is torn
+     *
+     * @param key Record key
+     */
+    void validate(uint8_t key)
+    {
+        if (isValidated(key) == true)
+        {
+            return;
+        }
+
+        Record record;
+        uint16_t keyPosition = getKeyPosition(key);
+        if (keyPosition != positionNone && load(keyPosition, record) == false)
+        {
+            // Torn record, fall back to the previous one
+            recover(key);
+        }
+        setValidated(key);
+    }
+
+    /**
+     * @brief Check if position holds the latest record of any key
+     * Record of the key which is not validated yet can be its fallback, the key is validated first
+     *
+     * @param position Record position
+     * @return true if record is live, false if it can be reclaimed
+     */
+    bool isLive(uint16_t position)
+    {
+        Record record;
+        if (loadHeader(position, record) == false)
+        {
+            // Erased record
+            return false;
+        }
+
+        validate(record.key);
+
+        return (getKeyPosition(record.key) == position);
+    }
+
+    /**
+     * @brief Reset records index to the empty journal
+     */
+    void resetIndex()
+    {
+#ifdef STORAGE_EEPROM
+        memset(keyPositions, positionNone, sizeof(keyPositions));
+#else
+        Storage::fill(indexAddress, positionNone & 0xFF, keysCount * sizeof(uint16_t));
+#endif
+        memset(keysValidated, 0, sizeof(keysValidated));
+        headPosition = 0;
+        nextSequence = 0;
+    }
+} // namespace
+
+/**
+ * @brief Initialize journal and recover the latest records
+ * Only sequence numbers and keys are scanned, the latest record of a key is validated on its first read
+ * or before a write reclaims a previous record of the key, only the newest record is checked here
+ *
+ * @return true if journal is found on the storage, false if it should be formatted
+ */
+bool Journal::initialize()
+{
+    resetIndex();
+
+    Header storedHeader;
+    Storage::get(headerAddress, storedHeader);
+    if (memcmp(&storedHeader, &header, sizeof(Header)) != 0)
+    {
+#ifdef LOG_DEBUG
+        Log::printf(F("Journal not found"));
+#endif // LOG_DEBUG
+        return false;
+    }
+
+    // Two newest records in the journal, only the last write can be torn
+    uint16_t lastPosition = positionNone;
+    uint32_t lastSequence = 0;
+    uint16_t previousPosition = positionNone;
+    uint32_t previousSequence = 0;
+
+    for (uint16_t position = 0; position < recordsCount; position++)
+    {
+        Record record;
+        if (loadHeader(position, record) == false)
+        {
+            // Erased record
+            continue;
+        }
+
+        uint16_t keyPosition = getKeyPosition(record.key);
+        uint32_t keySequence = 0;
+        if (keyPosition != positionNone)
+        {
+            // Sequence is read back from the storage to keep the scan off the stack
+            Storage::get(getAddress(keyPosition) + offsetof(Record, sequence), keySequence);
+        }
+
+        if (keyPosition == positionNone || record.sequence > keySequence)
+        {
+            // Newer record of the key
+            setKeyPosition(record.key, position);
+        }
+
+        if (lastPosition == positionNone || record.sequence > lastSequence)
+        {
+            // Newest record in the journal
+            previousPosition = lastPosition;
+            previousSequence = lastSequence;
+            lastPosition = position;
+            lastSequence = record.sequence;
+        }
+        else if (previousPosition == positionNone || record.sequence > previousSequence)
+        {
+            previousPosition = position;
+            previousSequence = record.sequence;
+        }
+    }
+
+    Record record;
+    if (lastPosition != positionNone && load(lastPosition, record) == false)
+    {
+        // Torn last write, its sequence can't be trusted, the journal continues after the previous record
+        lastPosition = previousPosition;
+        lastSequence = previousSequence;
+    }
+
+    if (lastPosition != positionNone)
+    {
+        // Continue right after the newest record
+        headPosition = (lastPosition + 1) % recordsCount;
+        nextSequence = lastSequence + 1;
+    }
+
+#ifdef LOG_DEBUG
+    Log::printf(F("Journal head %u seq %lu"), headPosition, nextSequence);
+#endif // LOG_DEBUG
+
+    return true;
+}
+
+/**
+ * @brief Format storage for the journal, all records are dropped
+ */
+void Journal::format()
+{
+    // Erase all records
+    for (uint16_t pageIdx = 0; pageIdx < Storage::pagesCount; pageIdx++)
+    {
+        Storage::fill(Storage::getPageAddress(pageIdx) + recordsOffset, 0xFF, recordsPerPage * sizeof(Record));
+    }
+    Storage::put(headerAddress, header);
+
+    resetIndex();
+}
+
+/**
+ * @brief Read latest record data of the key
+ *
+ * @param key Record key
+ * @param data Buffer for record data (dataSize bytes)
+ * @return true if record is found, false otherwise
+ */
+bool Journal::read(uint8_t key, void *data)
+{
+    bool result = false;
+
+    if (key < keysCount)
+    {
+        validate(key);
+
+        uint16_t keyPosition = getKeyPosition(key);
+        if (keyPosition != positionNone)
+        {
+            Record record;
+            Storage::get(getAddress(keyPosition), record);
+            memcpy(data, record.data, dataSize);
+            result = true;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Append new record for the key
+ *
+ * @param key Record key
+ * @param data Record data (dataSize bytes)
+ */
+void Journal::write(uint8_t key, const void *data)
+{
+    if (key >= keysCount)
+    {
+        return;
+    }
+
+    // Compact in place: reclaim the next stale record, live records are kept untouched
+    uint16_t position = headPosition;
+    while (isLive(position) == true)
+    {
+        position = (position + 1) % recordsCount;
+    }
+
+    Record record;
+    record.sequence = nextSequence++;
+    record.key = key;
+    memcpy(record.data, data, dataSize);
+    record.crc8 = calcCrc(record);
+
+    uint32_t address = getAddress(position);
+    // Invalidate reclaimed record first, sequence number is written last to commit the record
+    Storage::put(address + offsetof(Record, sequence), sequenceErased);
+    Storage::write(address + offsetof(Record, key), &record.key, sizeof(Record) - sizeof(record.sequence));
+    Storage::put(address + offsetof(Record, sequence), record.sequence);
+
+#ifdef LOG_DEBUG
+    Log::printf(F("Journal write key %u pos %u seq %lu"), key, position, record.sequence);
+#endif // LOG_DEBUG
+
+    setKeyPosition(key, position);
+    setValidated(key);
+    headPosition = (position + 1) % recordsCount;
+}
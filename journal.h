@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "storage.h"
+
+/**
+ * Append-only record journal over the storage
+ *
+ * Every write appends a new record with increasing sequence number and CRC to the next reclaimable
+ * position of the ring, the latest valid record of the key wins. Records being overwritten are never
+ * the live ones, so a torn write can only lose the record being written.
+ * Records never cross the storage page boundary.
+ */
+namespace Journal
+{
+    // Record payload size, bytes
+    static constexpr uint8_t dataSize = 15;
+    // Number of keys (key values are 0 .. keysCount - 1), about a third of the records count
+    static constexpr uint8_t keysCount = Storage::isEeprom ? 16 : 225;
+    // RAM taken by the index of the latest records, bytes, external storage keeps the positions itself
+    static constexpr uint16_t indexRamSize = (Storage::isEeprom ? keysCount * sizeof(uint16_t) : 0) + (keysCount + 7) / 8;
+
+    /**
+     * @brief Initialize journal and recover the latest records
+     * Only sequence numbers and keys are scanned, the latest record of a key is validated on its first read
+     * or before a write reclaims a previous record of the key, only the newest record is checked here
+     *
+     * @return true if journal is found on the storage, false if it should be formatted
+     */
+    bool initialize();
+
+    /**
+     * @brief Format storage for the journal, all records are dropped
+     */
+    void format();
+
+    /**
+     * @brief Read latest record data of the key
+     *
+     * @param key Record key
+     * @param data Buffer for record data (dataSize bytes)
+     * @return true if record is found, false otherwise
+     */
+    bool read(uint8_t key, void *data);
+
+    /**
+     * @brief Append new record for the key
+     *
+     * @param key Record key
+     * @param data Record data (dataSize bytes)
+     */
+    void write(uint8_t key, const void *data);
+} // namespace Journal
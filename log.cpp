@@ -1,8 +1,9 @@
 #include "log.h"
 
+#include <stdarg.h>
 #include <stdio.h>
 
-#include <Arduino.h>
+#include "hal.h"
 
 using namespace Log;
 
@@ -31,6 +32,25 @@ void Log::printf(const char *format, ...)
   vsnprintf(buffer, sizeof(buffer), format, args);
   va_end(args);
 
-  Serial.println(buffer);
+  Hal::Serial::println(buffer);
+#endif // LOG_ENABLE
+}
+
+/**
+ * @brief Print formatted string stored in program memory to the log
+ *
+ * @param format Formatted string in program memory, F() macro
+ * @param ... Parameters
+ */
+void Log::printf(const __FlashStringHelper *format, ...)
+{
+#ifdef LOG_ENABLE
+  va_list args;
+
+  va_start(args, format);
+  vsnprintf_P(buffer, sizeof(buffer), reinterpret_cast<const char *>(format), args);
+  va_end(args);
+
+  Hal::Serial::println(buffer);
 #endif // LOG_ENABLE
 }
@@ -1,5 +1,8 @@
 #pragma once
 
+// Flash strings for the log, F() macro
+#include "hal.h"
+
 namespace Log
 {
     /**
@@ -9,4 +12,12 @@ namespace Log
      * @param ... Parameters
      */
     void printf(const char *format, ...);
+
+    /**
+     * @brief Print formatted string stored in program memory to the log
+     *
+     * @param format Formatted string in program memory, F() macro
+     * @param ... Parameters
+     */
+    void printf(const __FlashStringHelper *format, ...);
 } // namespace Log
@@ -1,87 +1,200 @@
 #include "menu.h"
 
+#include <stdbool.h>
 #include <stdint.h>
 
+#include "hal.h"
+
 using namespace Menu;
 
 namespace
 {
-    const Item *navigate(const Item *pItem, Action action)
+    // Root item of the table
+    constexpr uint8_t rootItem = 0;
+
+    const Item *pItems = nullptr;
+    // Selected items from the root menu down to the current one
+    Level levels[depthMax];
+    uint8_t currentDepth = 0;
+
+    /**
+     * @brief Return parent of the menu level
+     *
+     * @param depth Menu level
+     * @return Parent item index
+     */
+    inline uint8_t getParent(uint8_t depth)
+    {
+        return (depth == 0) ? rootItem : levels[depth - 1].item;
+    }
+
+    /**
+     * @brief Select item at the position of the current menu
+     *
+     * @param position Position in the menu
+     */
+    void select(uint8_t position)
+    {
+        levels[currentDepth] = {getItem(position), position};
+    }
+
+    /**
+     * @brief Navigate through the menu according to the action
+     *
+     * @param item Selected item
+     * @param action New action
+     * @return true if another item is selected or menu should be redrawn, false otherwise
+     */
+    bool navigate(const Item &item, Action action)
     {
-        Item *pNewItem = nullptr;
+        Level &level = levels[currentDepth];
 
         switch (action)
         {
         case Action::Prev:
-            pNewItem = pItem->prev;
-            if (pNewItem != nullptr)
+            if (level.position == 0)
             {
-                // Save parent to exit properly
-                pNewItem->parent = pItem->parent;
+                return false;
             }
-            break;
+            select(level.position - 1);
+            return true;
 
         case Action::Next:
-            pNewItem = pItem->next;
-            if (pNewItem != nullptr)
+            if (level.position + 1 >= getCount())
             {
-                // Save parent to exit properly
-                pNewItem->parent = pItem->parent;
+                return false;
             }
-            break;
+            select(level.position + 1);
+            return true;
 
         case Action::Enter:
-            pNewItem = pItem->child;
-            if (pNewItem != nullptr)
+            if (item.child == noItem || item.childrenCount == 0 || currentDepth + 1 >= depthMax)
             {
-                // Save parent to exit properly
-                pNewItem->parent = pItem;
+                return false;
             }
-            break;
+            currentDepth++;
+            select(0);
+            return true;
 
         case Action::Back:
-            pNewItem = pItem->parent;
-            break;
+            if (currentDepth == 0)
+            {
+                return false;
+            }
+            // Upper level keeps the item it had selected
+            currentDepth--;
+            return true;
 
         case Action::Exit:
-            pNewItem = pItem;
-            break;
+            return true;
 
         default:
-            break;
+            return false;
         }
-
-        return pNewItem;
     }
 } // namespace
 
 /**
- * @brief Process menu action
+ * @brief Set menu tree, the first item of the root menu is selected
  *
- * @param pItem Current menu item
- * @param action New action
- * @return New menu item if selected, nullptr otherwise
+ * @param items Menu items in program memory, the first one is the root
  */
-const Item *Menu::process(const Item *pItem, Action action)
+void Menu::initialize(const Item *items)
 {
-    const Item *pNewItem = nullptr;
+    pItems = items;
+    currentDepth = 0;
+    select(0);
+}
 
-    if (pItem != nullptr)
+/**
+ * @brief Process menu action on the selected item
+ *
+ * @param action New action
+ * @return true if another item is selected or menu should be redrawn, false otherwise
+ */
+bool Menu::process(Action action)
+{
+    if (pItems == nullptr)
     {
-        FunctionState functionState = FunctionState::Inactive;
+        return false;
+    }
 
-        if (pItem->callback != nullptr)
-        {
-            // Process item's functionality
-            functionState = pItem->callback(action, pItem->param);
-        }
+    const Level &level = levels[currentDepth];
+    Item item;
+    readItem(level.item, item);
 
-        if (functionState == FunctionState::Inactive)
-        {
-            // Navigate through the menu according to the action
-            pNewItem = navigate(pItem, action);
-        }
+    FunctionState functionState = FunctionState::Inactive;
+
+    if (item.callback != nullptr)
+    {
+        // Process item's functionality
+        functionState = item.callback(action, level.position);
     }
 
-    return pNewItem;
+    if (functionState == FunctionState::Active)
+    {
+        return false;
+    }
+
+    // Navigate through the menu according to the action
+    return navigate(item, action);
+}
+
+/**
+ * @brief Return depth of the selected item
+ *
+ * @return Menu level, 0 for the root menu
+ */
+uint8_t Menu::getDepth()
+{
+    return currentDepth;
+}
+
+/**
+ * @brief Return selected item of the menu level
+ *
+ * @param depth Menu level, not deeper than the selected item
+ * @return Item and its position
+ */
+Level Menu::getLevel(uint8_t depth)
+{
+    return levels[(depth > currentDepth) ? currentDepth : depth];
+}
+
+/**
+ * @brief Return number of items in the menu of the selected item
+ *
+ * @return Items count
+ */
+uint8_t Menu::getCount()
+{
+    Item parent;
+    readItem(getParent(currentDepth), parent);
+
+    return parent.childrenCount;
+}
+
+/**
+ * @brief Return item at the position in the menu of the selected item
+ *
+ * @param position Position in the menu
+ * @return Item index
+ */
+uint8_t Menu::getItem(uint8_t position)
+{
+    Item parent;
+    readItem(getParent(currentDepth), parent);
+
+    return (parent.isList == true) ? parent.child : parent.child + position;
+}
+
+/**
+ * @brief Copy item from program memory
+ *
+ * @param itemIdx Item index
+ * @param item Object to copy the item
+ */
+void Menu::readItem(uint8_t itemIdx, Item &item)
+{
+    memcpy_P(&item, &pItems[itemIdx], sizeof(Item));
 }
@@ -1,7 +1,24 @@
 #pragma once
 
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Menu navigation
+ *
+ * Menu tree is a table of items in program memory, item 0 is the root. Children of an item are
+ * consecutive items of the table, so the position and the count of the siblings are known at once.
+ * Children of a list item are entries of a runtime list, all of them are the same child item.
+ * Selected item of every menu level is kept in a small stack in RAM, Back returns to the item
+ * selected on the upper level.
+ */
 namespace Menu
 {
+    // Item index meaning no item
+    static constexpr uint8_t noItem = 0xFF;
+    // Maximum number of menu levels below the root
+    static constexpr uint8_t depthMax = 4;
+
     /**
      * @brief Menu actions to process
      */
@@ -29,31 +46,128 @@ namespace Menu
      * @brief Menu item's functionality callback prototype
      *
      * @param action Menu action to proceed
-     * @param param Menu item's parameter
+     * @param param Position of the item in its menu
      * @return Menu item's functionality state
      */
     typedef FunctionState (*Callback)(Action action, int param);
 
     /**
-     * @brief Menu item structure
+     * @brief Menu item structure, stored in program memory
      */
     struct Item
     {
+        // Text in program memory, nullptr if the owner provides it
         const char *text;
-        const Item *prev;
-        const Item *next;
-        const Item *child;
+        // Functionality callback, nullptr if item has none
         Callback callback;
-        int param;
-        const Item *parent;
+        // First child item, noItem if item has no children
+        uint8_t child;
+        // Number of children
+        uint8_t childrenCount;
+        // Children are list entries, every one of them is the child item
+        bool isList;
+    };
+
+    /**
+     * @brief Selected item of a menu level
+     */
+    struct Level
+    {
+        // Item index
+        uint8_t item;
+        // Position of the item in its menu
+        uint8_t position;
     };
 
     /**
-     * @brief Process menu action
+     * @brief Make item without children
+     *
+     * @param text Text in program memory
+     * @param callback Functionality callback
+     * @return Menu item
+     */
+    constexpr Item makeItem(const char *text, Callback callback)
+    {
+        return {text, callback, noItem, 0, false};
+    }
+
+    /**
+     * @brief Make item with the submenu of consecutive items
+     *
+     * @param text Text in program memory
+     * @param firstChild First item of the submenu
+     * @param lastChild Last item of the submenu
+     * @param callback Functionality callback
+     * @return Menu item
+     */
+    constexpr Item makeMenu(const char *text, uint8_t firstChild, uint8_t lastChild, Callback callback = nullptr)
+    {
+        return {text, callback, firstChild, (uint8_t)(lastChild - firstChild + 1), false};
+    }
+
+    /**
+     * @brief Make item with the list of entries
+     *
+     * @param text Text in program memory
+     * @param entry Item of every list entry
+     * @param entriesCount Number of list entries
+     * @return Menu item
+     */
+    constexpr Item makeList(const char *text, uint8_t entry, uint8_t entriesCount)
+    {
+        return {text, nullptr, entry, entriesCount, true};
+    }
+
+    /**
+     * @brief Set menu tree, the first item of the root menu is selected
+     *
+     * @param items Menu items in program memory, the first one is the root
+     */
+    void initialize(const Item *items);
+
+    /**
+     * @brief Process menu action on the selected item
      *
-     * @param pItem Current menu item
      * @param action New action
-     * @return New menu item if selected, nullptr otherwise
+     * @return true if another item is selected or menu should be redrawn, false otherwise
+     */
+    bool process(Action action);
+
+    /**
+     * @brief Return depth of the selected item
+     *
+     * @return Menu level, 0 for the root menu
+     */
+    uint8_t getDepth();
+
+    /**
+     * @brief Return selected item of the menu level
+     *
+     * @param depth Menu level, not deeper than the selected item
+     * @return Item and its position
+     */
+    Level getLevel(uint8_t depth);
+
+    /**
+     * @brief Return number of items in the menu of the selected item
+     *
+     * @return Items count
+     */
+    uint8_t getCount();
+
+    /**
+     * @brief Return item at the position in the menu of the selected item
+     *
+     * @param position Position in the menu
+     * @return Item index
+     */
+    uint8_t getItem(uint8_t position);
+
+    /**
+     * @brief Copy item from program memory
+     *
+     * @param itemIdx Item index
+     * @param item Object to copy the item
      */
-    const Item *process(const Item *pItem, Action action);
+    void readItem(uint8_t itemIdx, Item &item);
 } // namespace Menu
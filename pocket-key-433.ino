@@ -1,13 +1,18 @@
+#include <stdint.h>
 #include <stdio.h>
-
-#include <Arduino.h>
-#include <RCSwitch.h>
+#include <string.h>
 
 #include "button.h"
+#include "band.h"
+#include "capture.h"
 #include "display.h"
+#include "hal.h"
 #include "log.h"
 #include "menu.h"
+#include "raw_frame.h"
+#include "receiver.h"
 #include "slot.h"
+#include "transmitter.h"
 
 // #define LOG_DEBUG // Uncomment to enable log printing
 
@@ -21,7 +26,7 @@ namespace
 
   namespace Battery
   {
-    constexpr uint8_t inputPin = A0;
+    constexpr uint8_t inputPin = Hal::Gpio::pinA0;
 
     constexpr uint16_t voltageMax = 5000;  // millivolts
     constexpr uint16_t rawValueMax = 1023; // bits
@@ -31,7 +36,7 @@ namespace
      */
     void initialize()
     {
-      pinMode(inputPin, INPUT);
+      Hal::Gpio::setMode(inputPin, Hal::Gpio::Mode::Input);
     }
 
     /**
@@ -41,7 +46,7 @@ namespace
      */
     uint16_t readVoltage()
     {
-      uint16_t rawValue = analogRead(inputPin);
+      uint16_t rawValue = Hal::Gpio::readAnalog(inputPin);
 
       // Calculate voltage from raw reading
       uint16_t voltage = (uint32_t)rawValue * voltageMax / rawValueMax;
@@ -56,6 +61,8 @@ namespace
     constexpr unsigned long systemInfoUpdatePeriodMs = 1000;
 
     constexpr uint8_t pageItemCount = 5;
+    // Characters of the menu item line
+    constexpr uint8_t itemLengthMax = 20;
     constexpr Display::Line displayLines[] = {
         Display::Line::Line_1,
         Display::Line::Line_2,
@@ -66,21 +73,26 @@ namespace
     static_assert(sizeof(displayLines) / sizeof(*displayLines) == pageItemCount);
 
     // String for root menu header
-    const char rootHeaderString[] = "Pocket Key";
-    const char authorString[] = "inspired by mr drone";
+    const char rootHeaderString[] PROGMEM = "Pocket Key";
 
     /**
      * @brief Show welcome screen
+     *
+     * @param headerString Header text in program memory
      */
     void showSystemInfo(const char *headerString)
     {
-      Display::printf(0, Display::Line::Header, "%-16.16s", headerString);
+      char header[16 + 1];
+      strncpy_P(header, headerString, sizeof(header) - 1);
+      header[sizeof(header) - 1] = '\0';
+
+      Display::printf(0, Display::Line::Header, F("%-16.16s"), header);
       Display::setStyle(Display::Style::Italic);
-      Display::printf(0, Display::Line::Line_1, authorString);
+      Display::printf(0, Display::Line::Line_1, F("inspired by mr drone"));
 
       uint16_t batteryVoltage = Battery::readVoltage();
-      Display::printf(0, Display::Line::Line_3, "Battery: %4umV", batteryVoltage);
-      Display::printf(0, Display::Line::Line_4, "Firmware: v%u.%u", FwVersion::major, FwVersion::minor);
+      Display::printf(0, Display::Line::Line_3, F("Battery: %4umV"), batteryVoltage);
+      Display::printf(0, Display::Line::Line_4, F("Firmware: v%u.%u"), FwVersion::major, FwVersion::minor);
     }
   } // namespace Menu
 
@@ -90,21 +102,77 @@ namespace
     constexpr uint8_t txPin = 10;
     // Receiver on pin #2 => that is interrupt 0
     constexpr uint8_t rxInterrupt = 0;
+    // Edge records drained from the capture buffer at once
+    constexpr uint8_t captureBatchSize = 16;
+    // Low level longer than this separates raw frames, microseconds
+    constexpr uint16_t rawGapMinUs = 4000;
+    // Longer separating low level is stored as this one, microseconds
+    constexpr uint16_t rawGapMaxUs = 30000;
+    // Minimum number of pulses in a raw frame
+    constexpr uint8_t rawPulsesMin = 16;
+    static_assert(RawFrame::packedSizeMax <= Slot::rawFrameSizeMax);
+    // Repeated frames are collected for this time after the first one, milliseconds
+    constexpr unsigned long voteWindowMs = 400;
+    // Frames of the same signal needed to accept it
+    constexpr uint8_t votesMin = 2;
+    // Voting is finished early once a signal gets this many frames
+    constexpr uint8_t votesEnough = 4;
+    // Distinct signals tracked while voting
+    constexpr uint8_t candidatesMax = 4;
+    // Distinct signals kept by the scan, two screen pages
+    constexpr uint8_t scanListSize = 2 * MainMenu::pageItemCount;
+
+    /**
+     * @brief Frames received for one signal
+     */
+    struct Candidate
+    {
+      Slot::Signal signal;
+      uint8_t votes;
+    };
+
+    /**
+     * @brief Signals received while voting
+     */
+    struct Consensus
+    {
+      Candidate candidates[candidatesMax];
+      uint8_t candidatesCount;
+      uint8_t framesCount;
+      unsigned long startTimeMs;
+    };
+
+    /**
+     * @brief Distinct signals received by the scan with their frame counts
+     */
+    struct ScanList
+    {
+      Slot::Signal signals[scanListSize];
+      uint16_t hits[scanListSize];
+      uint8_t count;
+    };
 
-    RCSwitch rcSwitch = RCSwitch();
+    /**
+     * @brief Raw frame being collected from the captured edges
+     */
+    struct RawFrameReader
+    {
+      uint16_t pulses[RawFrame::pulsesMax];
+      uint8_t pulsesCount;
+      bool isStarted;
+      bool isComplete;
+    };
 
     /**
      * @brief Initialize radio
      */
     void initialize()
     {
-      pinMode(rxPin, INPUT);
-      pinMode(txPin, OUTPUT);
+      Hal::Gpio::setMode(rxPin, Hal::Gpio::Mode::Input);
+      Hal::Gpio::setMode(txPin, Hal::Gpio::Mode::Output);
 
-      // Setup transmitter on TX pin
-      rcSwitch.enableTransmit(txPin);
-      // Set transmit repetition to 1 packet per command
-      rcSwitch.setRepeatTransmit(1);
+      // Setup transmitter on TX pin, frames are sent from the timer interrupt
+      Transmitter::initialize(txPin);
     }
 
     /**
@@ -112,11 +180,8 @@ namespace
      */
     inline void enableReciever()
     {
-      // Reset previous found signal if any
-      rcSwitch.resetAvailable();
-
-      // Enable receiver interrupt on RX pin
-      rcSwitch.enableReceive(rxInterrupt);
+      // Enable receiver interrupt on RX pin, previous found signal is dropped
+      Receiver::start(rxInterrupt);
     }
 
     /**
@@ -124,7 +189,7 @@ namespace
      */
     inline void disableReciever()
     {
-      rcSwitch.disableReceive();
+      Receiver::stop();
     }
 
     /**
@@ -135,26 +200,225 @@ namespace
      */
     bool readSignal(Slot::Signal &signal)
     {
-      bool result = rcSwitch.available();
-      if (result == true)
+      return Receiver::read(signal);
+    }
+
+    /**
+     * @brief Reset consensus, voting starts with the next frame
+     *
+     * @param consensus Consensus to reset
+     */
+    void resetConsensus(Consensus &consensus)
+    {
+      consensus.candidatesCount = 0;
+      consensus.framesCount = 0;
+    }
+
+    /**
+     * @brief Count received frame as a vote for its signal
+     * Frames of new signals are counted but not tracked if all candidates are taken
+     *
+     * @param consensus Consensus to update
+     * @param signal Received signal
+     */
+    void addVote(Consensus &consensus, const Slot::Signal &signal)
+    {
+      if (consensus.framesCount == 0)
+      {
+        consensus.startTimeMs = Hal::Clock::millis();
+      }
+      if (consensus.framesCount < UINT8_MAX)
+      {
+        consensus.framesCount++;
+      }
+
+      for (uint8_t idx = 0; idx < consensus.candidatesCount; idx++)
+      {
+        Candidate &candidate = consensus.candidates[idx];
+        if (candidate.signal == signal)
+        {
+          if (candidate.votes < UINT8_MAX)
+          {
+            // Measured pulse length is averaged over the frames
+            candidate.signal.pulseLengthUs = ((uint32_t)candidate.signal.pulseLengthUs * candidate.votes +
+                                              signal.pulseLengthUs) / (candidate.votes + 1);
+            candidate.votes++;
+          }
+          return;
+        }
+      }
+
+      if (consensus.candidatesCount < candidatesMax)
+      {
+        consensus.candidates[consensus.candidatesCount++] = {signal, 1};
+      }
+    }
+
+    /**
+     * @brief Return signal with the most votes, the earliest one wins a tie
+     *
+     * @param consensus Consensus to check
+     * @param signal Object to copy the winning signal
+     * @return Number of votes for the signal, 0 if no frames received
+     */
+    uint8_t getWinner(const Consensus &consensus, Slot::Signal &signal)
+    {
+      uint8_t votes = 0;
+      for (uint8_t idx = 0; idx < consensus.candidatesCount; idx++)
+      {
+        const Candidate &candidate = consensus.candidates[idx];
+        if (candidate.votes > votes)
+        {
+          votes = candidate.votes;
+          signal = candidate.signal;
+        }
+      }
+
+      return votes;
+    }
+
+    /**
+     * @brief Check if voting is finished
+     *
+     * @param consensus Consensus to check
+     * @return true if window is over or a signal got enough votes, false otherwise
+     */
+    bool isVotingDone(const Consensus &consensus)
+    {
+      if (consensus.framesCount == 0)
       {
-        signal.protocol = rcSwitch.getReceivedProtocol();
-        signal.value = rcSwitch.getReceivedValue();
-        signal.bitLength = rcSwitch.getReceivedBitlength();
+        return false;
       }
 
-      return result;
+      Slot::Signal signal;
+      return (getWinner(consensus, signal) >= votesEnough ||
+              Hal::Clock::millis() - consensus.startTimeMs >= voteWindowMs);
     }
 
     /**
-     * @brief Send signal to transmit
+     * @brief Count received frame in the scan list
+     * New signal takes the place of the one with the fewest hits if the list is full
      *
-     * @param signal Signal to transmit
+     * @param list Scan list to update
+     * @param signal Received signal
+     * @return Index of the signal in the list
      */
-    void sendSignal(const Slot::Signal &signal)
+    uint8_t addScanHit(ScanList &list, const Slot::Signal &signal)
     {
-      rcSwitch.setProtocol(signal.protocol);
-      rcSwitch.send(signal.value, signal.bitLength);
+      uint8_t rareIdx = 0;
+      for (uint8_t idx = 0; idx < list.count; idx++)
+      {
+        if (list.signals[idx] == signal)
+        {
+          if (list.hits[idx] < UINT16_MAX)
+          {
+            list.hits[idx]++;
+          }
+          return idx;
+        }
+        if (list.hits[idx] < list.hits[rareIdx])
+        {
+          rareIdx = idx;
+        }
+      }
+
+      uint8_t idx = (list.count < scanListSize) ? list.count++ : rareIdx;
+      list.signals[idx] = signal;
+      list.hits[idx] = 1;
+
+      return idx;
+    }
+
+    /**
+     * @brief Reset raw frame reader, frame starts after the next long low level
+     *
+     * @param reader Reader to reset
+     */
+    void resetRawFrame(RawFrameReader &reader)
+    {
+      reader.pulsesCount = 0;
+      reader.isStarted = false;
+      reader.isComplete = false;
+    }
+
+    /**
+     * @brief Collect raw frame from the captured edges
+     * Frame is the pulses between two long low levels, including the closing one
+     *
+     * @param reader Reader keeping the frame between calls
+     * @return true if frame is complete, false if more edges are needed
+     */
+    bool readRawFrame(RawFrameReader &reader)
+    {
+      if (reader.isComplete == true)
+      {
+        // The closing low level of the previous frame starts the next one
+        reader.pulsesCount = 0;
+        reader.isComplete = false;
+      }
+
+      uint16_t edge;
+      while (Capture::read(&edge, 1) > 0)
+      {
+        uint16_t durationUs = Capture::getDuration(edge);
+        bool isHighPulse = (Capture::getLevel(edge) == Hal::Gpio::levelLow);
+
+        if (isHighPulse == false && durationUs >= rawGapMinUs)
+        {
+          if (reader.isStarted == true && reader.pulsesCount + 1 >= rawPulsesMin &&
+              reader.pulsesCount < RawFrame::pulsesMax)
+          {
+            reader.pulses[reader.pulsesCount++] = (durationUs > rawGapMaxUs) ? rawGapMaxUs : durationUs;
+            reader.isComplete = true;
+            return true;
+          }
+
+          reader.pulsesCount = 0;
+          reader.isStarted = true;
+        }
+        else if (reader.isStarted == true)
+        {
+          // Levels alternate starting from high unless edges are dropped, frame is too long otherwise
+          if (isHighPulse != ((reader.pulsesCount % 2) == 0) || reader.pulsesCount == RawFrame::pulsesMax)
+          {
+            resetRawFrame(reader);
+          }
+          else
+          {
+            reader.pulses[reader.pulsesCount++] = durationUs;
+          }
+        }
+      }
+
+      return false;
+    }
+
+    /**
+     * @brief Return name of the transmitter output mode
+     *
+     * @param output Transmitter output mode
+     * @return Output mode name in program memory
+     */
+    const char *getOutputName(Transmitter::Output output)
+    {
+      return (output == Transmitter::Output::Timer) ? PSTR("timer") : PSTR("isr");
+    }
+
+    /**
+     * @brief Return pulse length the signal is sent with
+     *
+     * @param signal Decoded signal
+     * @return Measured pulse length if known, protocol one otherwise, microseconds
+     */
+    uint16_t getPulseLength(const Slot::Signal &signal)
+    {
+      Protocol::Timing timing;
+      if (signal.pulseLengthUs != 0 || Protocol::getTiming(signal.protocol, timing) == false)
+      {
+        return signal.pulseLengthUs;
+      }
+
+      return timing.pulseLength;
     }
   } // namespace Radio
 
@@ -162,69 +426,147 @@ namespace
   Menu::FunctionState slotItemCallback(Menu::Action action, int param);
   Menu::FunctionState slotEmulateCallback(Menu::Action action, int param);
   Menu::FunctionState slotSearchCallback(Menu::Action action, int param);
+  Menu::FunctionState slotRawSearchCallback(Menu::Action action, int param);
   Menu::FunctionState slotEditNameCallback(Menu::Action action, int param);
+  Menu::FunctionState slotScanCallback(Menu::Action action, int param);
+  Menu::FunctionState monitorCallback(Menu::Action action, int param);
+  Menu::FunctionState sequenceCallback(Menu::Action action, int param);
   Menu::FunctionState systemCallback(Menu::Action action, int param);
+  Menu::FunctionState captureCallback(Menu::Action action, int param);
+  Menu::FunctionState protocolsCallback(Menu::Action action, int param);
+  Menu::FunctionState bandCallback(Menu::Action action, int param);
 
   namespace MenuItem
   {
-    const char allowedChars[] = " 0123456789ABCDEFGHIJKLMNOPQRSTUVWXWZabcdefghijklmnopqrstuvwxyz";
-
-    // Menu item definitions
-    extern Menu::Item slotRoot;
-    extern Menu::Item slotList[];
-    extern Menu::Item slotEmulate;
-    extern Menu::Item slotSearch;
-    extern Menu::Item slotEditName;
-    extern Menu::Item settings;
-    extern Menu::Item system;
-
-    // Root menu
-    Menu::Item slotRoot = {"Slots", nullptr, &settings, slotList};
-    Menu::Item settings = {"Settings", &slotRoot, nullptr, &system};
-
-    // Slots list menu
-    Menu::Item slotList[Slot::slotsCount] = {0};
-    char slotNameList[Slot::slotsCount][Slot::nameLengthMax + 1] = {0};
+    /**
+     * @brief Menu item identifiers, items of one menu are consecutive
+     */
+    enum Id : uint8_t
+    {
+      Root,
+      // Root menu
+      Slots,
+      Monitor,
+      Sequence,
+      Settings,
+      // Slots list entry, it stands for every slot
+      SlotEntry,
+      // Slot item menu
+      SlotEmulate,
+      SlotSearch,
+      SlotRawSearch,
+      SlotEditName,
+      SlotScan,
+      // Settings menu
+      SettingsSystem,
+      SettingsCapture,
+      SettingsProtocols,
+      SettingsBand,
+      Count,
+    };
 
-    // Slot item menu
-    Menu::Item slotEmulate = {"Emulate", nullptr, &slotSearch, nullptr, slotEmulateCallback};
-    Menu::Item slotSearch = {"Search", &slotEmulate, &slotEditName, nullptr, slotSearchCallback};
-    Menu::Item slotEditName = {"Edit name", &slotSearch, nullptr, nullptr, slotEditNameCallback};
+    const char slotsText[] PROGMEM = "Slots";
+    const char monitorText[] PROGMEM = "Monitor";
+    const char sequenceText[] PROGMEM = "Sequence";
+    const char settingsText[] PROGMEM = "Settings";
+    const char emulateText[] PROGMEM = "Emulate";
+    const char searchText[] PROGMEM = "Search";
+    const char rawSearchText[] PROGMEM = "Raw search";
+    const char editNameText[] PROGMEM = "Edit name";
+    const char scanText[] PROGMEM = "Scan";
+    const char systemText[] PROGMEM = "System";
+    const char captureText[] PROGMEM = "Raw capture";
+    const char protocolsText[] PROGMEM = "Protocols";
+    const char bandText[] PROGMEM = "Band monitor";
+
+    // Menu tree, text of the slot entries is the slot name
+    const Menu::Item items[Count] PROGMEM = {
+        Menu::makeMenu(MainMenu::rootHeaderString, Slots, Settings),
+        // Root menu
+        Menu::makeList(slotsText, SlotEntry, Slot::slotsCount),
+        Menu::makeItem(monitorText, monitorCallback),
+        Menu::makeItem(sequenceText, sequenceCallback),
+        Menu::makeMenu(settingsText, SettingsSystem, SettingsBand),
+        // Slots list entry
+        Menu::makeMenu(nullptr, SlotEmulate, SlotScan, slotItemCallback),
+        // Slot item menu
+        Menu::makeItem(emulateText, slotEmulateCallback),
+        Menu::makeItem(searchText, slotSearchCallback),
+        Menu::makeItem(rawSearchText, slotRawSearchCallback),
+        Menu::makeItem(editNameText, slotEditNameCallback),
+        Menu::makeItem(scanText, slotScanCallback),
+        // Settings menu
+        Menu::makeItem(systemText, systemCallback),
+        Menu::makeItem(captureText, captureCallback),
+        Menu::makeItem(protocolsText, protocolsCallback),
+        Menu::makeItem(bandText, bandCallback),
+    };
+    static_assert(Count <= Menu::noItem);
 
-    // Settings menu
-    Menu::Item system = {"System", nullptr, nullptr, nullptr, systemCallback};
+    // Names of the slots on the shown page of the list
+    char slotPageNames[MainMenu::pageItemCount][Slot::nameLengthMax + 1] = {0};
+    uint8_t slotPageFirstIdx = Slot::slotsCount;
 
-    uint8_t getCharAllowedIdx(char ch)
+    /**
+     * @brief Load names of the slots on the list page
+     *
+     * @param slotIdx Slot identifier to show, page is aligned to the page items count
+     */
+    void loadSlotPage(uint8_t slotIdx)
     {
-      uint8_t charIdx = strlen(allowedChars) - 1;
-      while (charIdx > 0 && ch != allowedChars[charIdx])
+      slotPageFirstIdx = slotIdx - (slotIdx % MainMenu::pageItemCount);
+
+      for (uint8_t itemOffset = 0; itemOffset < MainMenu::pageItemCount; itemOffset++)
       {
-        charIdx--;
+        uint8_t pageSlotIdx = slotPageFirstIdx + itemOffset;
+        if (pageSlotIdx >= Slot::slotsCount)
+        {
+          break;
+        }
+        Slot::getName(pageSlotIdx, slotPageNames[itemOffset]);
       }
+    }
 
-      return charIdx;
+    /**
+     * @brief Return name buffer of the slot shown on the current page
+     *
+     * @param slotIdx Slot identifier (should be on the current page)
+     * @return Slot name shown in the menu
+     */
+    char *getSlotPageName(uint8_t slotIdx)
+    {
+      return slotPageNames[slotIdx - slotPageFirstIdx];
     }
 
     /**
-     * @brief Setup slot menu items with slot data
+     * @brief Return text of the menu item
+     *
+     * @param itemIdx Item index
+     * @param position Position of the item in its menu
+     * @param buffer Buffer for the text stored in program memory
+     * @param size Buffer size
+     * @return Item text
      */
-    void setupSlots()
+    const char *getText(uint8_t itemIdx, uint8_t position, char *buffer, uint8_t size)
     {
-      for (uint8_t slotIdx = 0; slotIdx < Slot::slotsCount; slotIdx++)
+      if (itemIdx == SlotEntry)
       {
-        Menu::Item &itemMenu = MenuItem::slotList[slotIdx];
-        itemMenu.text = slotNameList[slotIdx];
-        Slot::getName(slotIdx, itemMenu.text);
-        itemMenu.prev = (slotIdx == 0) ? nullptr : &MenuItem::slotList[slotIdx - 1];
-        itemMenu.next = (slotIdx == Slot::slotsCount - 1) ? nullptr : &MenuItem::slotList[slotIdx + 1];
-        itemMenu.child = &MenuItem::slotEmulate;
-        itemMenu.callback = slotItemCallback;
-        itemMenu.param = slotIdx;
+        // Slot names are read from the storage a page at once
+        if (position - (position % MainMenu::pageItemCount) != slotPageFirstIdx)
+        {
+          loadSlotPage(position);
+        }
+        return getSlotPageName(position);
       }
+
+      Menu::Item item;
+      Menu::readItem(itemIdx, item);
+      strncpy_P(buffer, item.text, size - 1);
+      buffer[size - 1] = '\0';
+      return buffer;
     }
   } // namespace MenuItem
 
-  const Menu::Item *pCurrentMenu = &MenuItem::slotRoot;
   uint8_t selectedSlotIdx = Slot::invalidIdx;
 
   /**
@@ -287,75 +629,77 @@ namespace
     return menuAction;
   }
 
+  // Screen shows the menu of the selected item
+  bool isMenuDrawn = false;
+  // Position of the item shown as selected
+  uint8_t drawnPosition = 0;
+
   /**
-   * @brief Draw specified menu item
-   * Set menu item as current
+   * @brief Draw menu of the selected item
+   * Moving to the neighbour item on the same page repaints only the two changed rows and the position,
+   * the whole menu is drawn otherwise
    *
-   * @param pDrawItem Menu item to draw
+   * @param action Menu action selected the item
    */
-  void drawMenu(const Menu::Item *pDrawItem)
+  void drawMenu(Menu::Action action)
   {
-    if (pDrawItem != nullptr)
-    {
-      bool isRootMenu = (pDrawItem->parent == nullptr);
+    uint8_t depth = Menu::getDepth();
+    Menu::Level level = Menu::getLevel(depth);
+    char text[MainMenu::itemLengthMax + 1];
 
-      // Show parent header text
-      const char *headerText = isRootMenu ? MainMenu::rootHeaderString : pDrawItem->parent->text;
-      Display::printf(0, Display::Line::Header, "%-16.16s", headerText);
+    if (isMenuDrawn == true && (action == Menu::Action::Prev || action == Menu::Action::Next) &&
+        level.position / MainMenu::pageItemCount == drawnPosition / MainMenu::pageItemCount)
+    {
+      Display::printf(0, MainMenu::displayLines[drawnPosition % MainMenu::pageItemCount], F("%-20.20s"),
+                      MenuItem::getText(Menu::getItem(drawnPosition), drawnPosition, text, sizeof(text)));
+      Display::setInverted(true);
+      Display::printf(0, MainMenu::displayLines[level.position % MainMenu::pageItemCount], F("%-20.20s"),
+                      MenuItem::getText(level.item, level.position, text, sizeof(text)));
+      Display::printf(7, Display::Line::Navigation, F("%3u"), level.position + 1);
 
-      // Count previous items
-      uint8_t prevItemCount = 0;
-      const Menu::Item *pItem = pDrawItem->prev;
-      while (pItem != nullptr)
-      {
-        prevItemCount++;
-        pItem = pItem->prev;
-      }
+      drawnPosition = level.position;
+      return;
+    }
 
-      // Count next items
-      uint8_t nextItemCount = 0;
-      pItem = pDrawItem->next;
-      while (pItem != nullptr)
-      {
-        nextItemCount++;
-        pItem = pItem->next;
-      }
+    bool isRootMenu = (depth == 0);
 
-      // Show navigation info
-      uint8_t itemIdx = prevItemCount;
-      uint8_t itemsCount = prevItemCount + 1 + nextItemCount;
-      Display::printf(0, Display::Line::Navigation,
-                      isRootMenu ? "        %2u/%-2u  ENTER>" : "<BACK   %2u/%-2u  ENTER>",
-                      itemIdx + 1, itemsCount);
+    // Show parent header text
+    Menu::Level parentLevel = {MenuItem::Root, 0};
+    if (isRootMenu == false)
+    {
+      parentLevel = Menu::getLevel(depth - 1);
+    }
+    Display::printf(0, Display::Line::Header, F("%-16.16s"),
+                    MenuItem::getText(parentLevel.item, parentLevel.position, text, sizeof(text)));
+
+    // Show navigation info
+    uint8_t itemsCount = Menu::getCount();
+    Display::printf(0, Display::Line::Navigation,
+                    isRootMenu ? F("       %3u/%-3u ENTER>") : F("<BACK  %3u/%-3u ENTER>"),
+                    level.position + 1, itemsCount);
+
+    // Fill menu items on current page
+    uint8_t pageFirstPosition = level.position - (level.position % MainMenu::pageItemCount);
+    for (uint8_t itemOffset = 0; itemOffset < MainMenu::pageItemCount; itemOffset++)
+    {
+      Display::Line line = MainMenu::displayLines[itemOffset];
+      uint8_t position = pageFirstPosition + itemOffset;
 
-      // Find the first item on current page
-      uint8_t itemOffset = itemIdx % MainMenu::pageItemCount;
-      pItem = pDrawItem;
-      while (itemOffset > 0)
+      if (position >= itemsCount)
       {
-        pItem = pItem->prev;
-        itemOffset--;
+        Display::printf(0, line, F("%-20.20S"), PSTR(""));
+        continue;
       }
 
-      // Fill menu items on current page
-      while (itemOffset < MainMenu::pageItemCount)
+      if (position == level.position)
       {
-        Display::Line line = MainMenu::displayLines[itemOffset];
-
-        if (pItem == pDrawItem)
-        {
-          Display::setInverted(true);
-          Display::printf(0, line, "%-20.20s", pItem->text);
-        }
-        else
-        {
-          Display::printf(0, line, "%-20.20s", pItem ? pItem->text : "");
-        }
-
-        pItem = pItem ? pItem->next : nullptr;
-        itemOffset++;
+        Display::setInverted(true);
       }
+      Display::printf(0, line, F("%-20.20s"), MenuItem::getText(Menu::getItem(position), position, text, sizeof(text)));
     }
+
+    isMenuDrawn = true;
+    drawnPosition = level.position;
   }
 
   /**
@@ -367,14 +711,12 @@ namespace
    */
   Menu::FunctionState slotItemCallback(Menu::Action action, int param)
   {
-    Menu::FunctionState functionState = Menu::FunctionState::Inactive;
-
     if (action == Menu::Action::Enter)
     {
       selectedSlotIdx = param;
     }
 
-    return functionState;
+    return Menu::FunctionState::Inactive;
   }
 
   /**
@@ -394,9 +736,16 @@ namespace
       Sending,
     };
 
+    // Period of the sending counter update, milliseconds
+    constexpr unsigned long counterUpdatePeriodMs = 250;
+
     static State state = State::Disabled;
     static Slot::Signal txSignal = Slot::signalInvalid;
-    static uint16_t txCount = 0;
+    // Frame waveform is encoded once when the signal is opened
+    static Transmitter::Waveform txWaveform;
+    static uint16_t txFramesStart = 0;
+    static unsigned long txStartTimeMs = 0;
+    static unsigned long lastUpdateTimeMs = 0;
 
     // Handle new action
     switch (action)
@@ -404,6 +753,8 @@ namespace
     case Menu::Action::Exit:
       if (state != State::Disabled)
       {
+        // Drop frames not sent yet
+        Transmitter::stop();
         Display::clear();
         txSignal = Slot::signalInvalid;
         // Switch to disabled state
@@ -417,27 +768,61 @@ namespace
         // Update display
         Display::clear();
         Slot::getSignal(selectedSlotIdx, txSignal);
+        if (Slot::isRaw(txSignal) == true)
+        {
+          // Raw frame is unpacked straight to the waveform
+          uint8_t packedFrame[Slot::rawFrameSizeMax];
+          if (Slot::loadRawFrame(txSignal, packedFrame) == false ||
+              RawFrame::decode(packedFrame, txWaveform) == false)
+          {
+            txSignal = Slot::signalInvalid;
+          }
+        }
         if (txSignal == Slot::signalInvalid)
         {
-          Display::printf(0, Display::Line::Header, "%-16.16s", "No signal saved");
-          Display::printf(0, Display::Line::Line_1, "Go to search menu");
-          Display::printf(0, Display::Line::Navigation, "<<EXIT");
+          Display::printf(0, Display::Line::Header, F("No signal saved "));
+          Display::printf(0, Display::Line::Line_1, F("Go to search menu"));
+          Display::printf(0, Display::Line::Navigation, F("<<EXIT"));
           // Switch to no signal state
           state = State::NoSignal;
         }
         else
         {
-          Display::printf(0, Display::Line::Header, "%-16.16s", "Signal TX");
-          Display::printf(0, Display::Line::Line_1, "Protocol: %02u", txSignal.protocol);
-          Display::printf(0, Display::Line::Line_2, "Value: 0x%02lX", txSignal.value);
-          Display::printf(0, Display::Line::Line_3, "Bits: %2u", txSignal.bitLength);
-          Display::printf(0, Display::Line::Navigation, "<<EXIT          SEND>");
+          Display::printf(0, Display::Line::Header, F("Signal TX       "));
+          if (Slot::isRaw(txSignal) == true)
+          {
+            Display::printf(0, Display::Line::Line_1, F("Protocol: raw"));
+            Display::printf(0, Display::Line::Line_2, F("Pulses: %u"), txWaveform.pulsesCount);
+            Display::printf(0, Display::Line::Line_3, F("Size: %u bytes"), txSignal.bitLength);
+          }
+          else
+          {
+            Transmitter::encode(txSignal, txWaveform);
+            Display::printf(0, Display::Line::Line_1, F("Protocol: %02u %5uus"), txSignal.protocol,
+                            Radio::getPulseLength(txSignal));
+            Display::printf(0, Display::Line::Line_2, F("Value: 0x%02lX"), txSignal.value);
+            Display::printf(0, Display::Line::Line_3, F("Bits: %2u"), txSignal.bitLength);
+          }
+          Display::printf(0, Display::Line::Line_4, F("Out:%-16S"), Radio::getOutputName(Transmitter::getOutput()));
+          Display::printf(0, Display::Line::Navigation, F("<<EXIT          SEND>"));
           // Switch to signal opened state
           state = State::SignalOpened;
         }
       }
       break;
 
+    case Menu::Action::Prev:
+      if (state == State::SignalOpened)
+      {
+        // Test mode, edge timing of both outputs can be compared on the same signal
+        Transmitter::Output output = (Transmitter::getOutput() == Transmitter::Output::Timer)
+                                         ? Transmitter::Output::Interrupt
+                                         : Transmitter::Output::Timer;
+        Transmitter::setOutput(output);
+        Display::printf(0, Display::Line::Line_4, F("Out:%-16S"), Radio::getOutputName(Transmitter::getOutput()));
+      }
+      break;
+
     default:
       break;
     }
@@ -448,31 +833,61 @@ namespace
       if (buttonEvent == Button::Event::PressStart)
       {
         // Update display
-        Display::printf(0, Display::Line::Header, "%-16.16s", "Sending...");
-        Display::printf(0, Display::Line::Navigation, "<<EXIT         SEND>>");
+        Display::printf(0, Display::Line::Header, F("Sending...      "));
+        Display::printf(0, Display::Line::Navigation, F("<<EXIT         SEND>>"));
         // Switch to sending state
-        txCount = 0;
+        txFramesStart = Transmitter::getFramesSent();
+        Transmitter::resetEdgeStats();
+        txStartTimeMs = Hal::Clock::millis();
+        lastUpdateTimeMs = txStartTimeMs;
         state = State::Sending;
       }
     }
 
     if (state == State::Sending)
     {
+      uint16_t txCount = Transmitter::getFramesSent() - txFramesStart;
       Button::State buttonState = Button::getState(Button::Id::Right);
       if (buttonState == Button::State::Released)
       {
-        // Update display
-        Display::printf(0, Display::Line::Header, "%-16.16s", "Signal TX");
-        Display::printf(0, Display::Line::Navigation, "<<EXIT          SEND>");
-        // Switch back to signal opened state
-        state = State::SignalOpened;
+        // Frames already queued are completed
+        if (Transmitter::isBusy() == false)
+        {
+          // Update display with the final counter and rate
+          unsigned long txTimeMs = Hal::Clock::millis() - txStartTimeMs;
+          Display::printf(0, Display::Line::Header, F("Signal TX       "));
+          Display::printf(0, Display::Line::Line_5, F("Sent: %u, %lu fps"), txCount,
+                          (txTimeMs > 0) ? txCount * 1000UL / txTimeMs : 0);
+          // Worst edge delay against the frame durations
+          Transmitter::EdgeStats edgeStats;
+          Transmitter::getEdgeStats(edgeStats);
+          Display::printf(0, Display::Line::Line_4, F("Out:%-5S err:%4uus"),
+                          Radio::getOutputName(Transmitter::getOutput()), edgeStats.errorMaxUs);
+          Display::printf(0, Display::Line::Navigation, F("<<EXIT          SEND>"));
+#ifdef LOG_DEBUG
+          Log::printf(F("Tx %u frames in %lu ms"), txCount, txTimeMs);
+          Log::printf(F("Tx %u edges, error max %u us, %u late"), edgeStats.edgesCount,
+                      edgeStats.errorMaxUs, edgeStats.lateCount);
+#endif // LOG_DEBUG
+          // Switch back to signal opened state
+          state = State::SignalOpened;
+        }
       }
       else
       {
-        // Send signal to the radio
-        Radio::sendSignal(txSignal);
-        txCount++;
-        Display::printf(9, Display::Line::Navigation, "%03u", txCount);
+        // Keep the next frame queued, so frames go back-to-back
+        if (Transmitter::getQueuedCount() < 2)
+        {
+          Transmitter::enqueue(txWaveform, 1, 0);
+        }
+
+        // Counter is updated on its own schedule while frames are sent from the interrupt
+        unsigned long currentTimeMs = Hal::Clock::millis();
+        if (currentTimeMs - lastUpdateTimeMs >= counterUpdatePeriodMs)
+        {
+          lastUpdateTimeMs = currentTimeMs;
+          Display::printf(9, Display::Line::Navigation, F("%03u"), txCount);
+        }
       }
     }
 
@@ -484,6 +899,7 @@ namespace
 
   /**
    * @brief Slot searching menu item's functionality callback
+   * Repeated frames are voted on, only a signal received several times is offered for saving
    *
    * @param action New menu action
    * @param param Menu item's parameter
@@ -495,12 +911,16 @@ namespace
     {
       Disabled,
       Searching,
+      Voting,
       Found,
+      Saving,
       Saved,
     };
 
     static State state = State::Disabled;
     static Slot::Signal rxSignal = Slot::signalInvalid;
+    static uint8_t rxSlotIdx = Slot::invalidIdx;
+    static Radio::Consensus consensus;
 
     // Handle new action
     switch (action)
@@ -517,13 +937,15 @@ namespace
       break;
 
     case Menu::Action::Enter:
-      if (state == State::Disabled || state == State::Found || state == State::Saved)
+      if (state == State::Disabled || state == State::Found ||
+          state == State::Saving || state == State::Saved)
       {
         // Update display
         Display::clear();
-        Display::printf(0, Display::Line::Header, "%-16.16s", "Searching...");
-        Display::printf(0, Display::Line::Line_1, "Please wait");
-        Display::printf(0, Display::Line::Navigation, "<<EXIT");
+        Display::printf(0, Display::Line::Header, F("Searching...    "));
+        Display::printf(0, Display::Line::Line_1, F("Please wait"));
+        Display::printf(0, Display::Line::Navigation, F("<<EXIT"));
+        Radio::resetConsensus(consensus);
         // Enable radio receiver
         Radio::enableReciever();
         // Switch to searching state
@@ -534,12 +956,17 @@ namespace
     case Menu::Action::Set:
       if (state == State::Found)
       {
-        // Set signal to current selected slot
-        Slot::setSignal(selectedSlotIdx, rxSignal);
+        if (rxSlotIdx != selectedSlotIdx)
+        {
+          // Set signal to current selected slot, it is saved on the storage in background
+          Slot::begin(selectedSlotIdx);
+          Slot::modifySignal(rxSignal);
+          Slot::commit();
+        }
         // Update display
-        Display::printf(0, Display::Line::Navigation, "<<EXIT        REPEAT>");
-        // Switch to saved state
-        state = State::Saved;
+        Display::printf(0, Display::Line::Navigation, F("<<EXIT SAVING REPEAT>"));
+        // Switch to saving state
+        state = State::Saving;
       }
       break;
 
@@ -547,24 +974,70 @@ namespace
       break;
     }
 
-    if (state == State::Searching)
+    if (state == State::Saving)
+    {
+      if (Slot::isPending() == false)
+      {
+        // Update display
+        Display::printf(0, Display::Line::Navigation, F("<<EXIT SAVED  REPEAT>"));
+        // Switch to saved state
+        state = State::Saved;
+      }
+    }
+
+    if (state == State::Searching || state == State::Voting)
     {
       bool isSignalRead = Radio::readSignal(rxSignal);
       if (isSignalRead == true)
       {
+#ifdef LOG_DEBUG
+        Log::printf(F("Rx %02u: %u/%u"), rxSignal.protocol, rxSignal.value, rxSignal.bitLength);
+#endif // LOG_DEBUG
+
+        Radio::addVote(consensus, rxSignal);
+        Display::printf(0, Display::Line::Line_2, F("Frames: %-12u"), consensus.framesCount);
+        // Switch to voting state
+        state = State::Voting;
+      }
+    }
+
+    if (state == State::Voting && Radio::isVotingDone(consensus) == true)
+    {
+      uint8_t votes = Radio::getWinner(consensus, rxSignal);
+      if (votes < Radio::votesMin)
+      {
+        // Single frame may be noise or a partial frame, keep searching
+        Display::printf(0, Display::Line::Line_2, F("Not confirmed       "));
+        Radio::resetConsensus(consensus);
+        // Switch back to searching state
+        state = State::Searching;
+      }
+      else
+      {
         Radio::disableReciever();
+        uint8_t confidence = votes * 100U / consensus.framesCount;
 
 #ifdef LOG_DEBUG
-        Log::printf("Rx %02u: %u/%u", rxSignal.protocol, rxSignal.value, rxSignal.bitLength);
+        Log::printf(F("Rx %02u: %u/%u, %u of %u frames"), rxSignal.protocol, rxSignal.value, rxSignal.bitLength,
+                    votes, consensus.framesCount);
 #endif // LOG_DEBUG
 
         // Update display
         Display::clear();
-        Display::printf(0, Display::Line::Header, "%-16.16s", "Signal RX");
-        Display::printf(0, Display::Line::Line_1, "Protocol: %02u", rxSignal.protocol);
-        Display::printf(0, Display::Line::Line_2, "Value: 0x%02lX", rxSignal.value);
-        Display::printf(0, Display::Line::Line_3, "Bits: %2u", rxSignal.bitLength);
-        Display::printf(0, Display::Line::Navigation, "<<EXIT REPEAT>/SAVE>>");
+        Display::printf(0, Display::Line::Header, F("Signal RX %3u%%"), confidence);
+        Display::printf(0, Display::Line::Line_1, F("Protocol: %02u %5uus"), rxSignal.protocol, rxSignal.pulseLengthUs);
+        Display::printf(0, Display::Line::Line_2, F("Value: 0x%02lX"), rxSignal.value);
+        Display::printf(0, Display::Line::Line_3, F("Bits: %2u  Frames:%u/%u"), rxSignal.bitLength,
+                        votes, consensus.framesCount);
+        rxSlotIdx = Slot::findSignal(rxSignal);
+        if (rxSlotIdx != Slot::invalidIdx)
+        {
+          char slotName[Slot::nameLengthMax + 1];
+          Slot::getName(rxSlotIdx, slotName);
+          Display::printf(0, Display::Line::Line_4, F("Already in slot %u"), rxSlotIdx + 1);
+          Display::printf(0, Display::Line::Line_5, F("%s"), slotName);
+        }
+        Display::printf(0, Display::Line::Navigation, F("<<EXIT REPEAT>/SAVE>>"));
 
         // Switch to saved state
         state = State::Found;
@@ -578,26 +1051,28 @@ namespace
   }
 
   /**
-   * @brief Slot name editing item's functionality callback
+   * @brief Slot raw searching menu item's functionality callback
+   * Captures a frame of any protocol, the frame is packed to fit the slot storage
    *
    * @param action New menu action
    * @param param Menu item's parameter
    * @return Current menu item's function state
    */
-  Menu::FunctionState slotEditNameCallback(Menu::Action action, int param)
+  Menu::FunctionState slotRawSearchCallback(Menu::Action action, int param)
   {
     enum class State
     {
       Disabled,
-      Refresh,
-      WaitInput,
+      Searching,
+      Found,
+      Saving,
+      Saved,
     };
 
     static State state = State::Disabled;
-    static const char *currentName = nullptr;
-    static char newName[Slot::nameLengthMax + 1];
-    static uint8_t editCharOffset;
-    static uint8_t editCharAllowedIdx;
+    static Radio::RawFrameReader reader;
+    static uint8_t packedFrame[RawFrame::packedSizeMax];
+    static uint8_t packedSize = 0;
 
     // Handle new action
     switch (action)
@@ -606,106 +1081,986 @@ namespace
       if (state != State::Disabled)
       {
         Display::clear();
+        Capture::stop();
         // Switch to disabled state
         state = State::Disabled;
       }
       break;
 
     case Menu::Action::Enter:
-      if (state == State::Disabled)
+      if (state == State::Disabled || state == State::Found ||
+          state == State::Saving || state == State::Saved)
       {
         // Update display
         Display::clear();
-        Display::printf(0, Display::Line::Header, "%-16.16s", "Edit name");
-        // Copy current slot name
-        currentName = MenuItem::slotNameList[selectedSlotIdx];
-        snprintf(newName, sizeof(newName), "%-12s", currentName);
-        editCharOffset = 0;
-        editCharAllowedIdx = MenuItem::getCharAllowedIdx(newName[editCharOffset]);
-        // Switch to refresh state
-        state = State::Refresh;
+        Display::printf(0, Display::Line::Header, F("Raw search...   "));
+        Display::printf(0, Display::Line::Line_1, F("Please wait"));
+        Display::printf(0, Display::Line::Navigation, F("<<EXIT"));
+        // Capture edges of any protocol
+        Radio::resetRawFrame(reader);
+        Capture::start(Radio::rxInterrupt, Radio::rxPin);
+        // Switch to searching state
+        state = State::Searching;
       }
-      else if (state == State::WaitInput)
+      break;
+
+    case Menu::Action::Set:
+      if (state == State::Found && packedSize > 0)
       {
-        if (editCharOffset < Slot::nameLengthMax - 1)
+        // Frame is written right away, the slot refers to it once it is committed
+        Slot::Signal rawSignal;
+        if (Slot::saveRawFrame(selectedSlotIdx, packedFrame, packedSize, rawSignal) == true)
         {
-          // Shift cursor to the right
-          editCharOffset++;
+          Slot::begin(selectedSlotIdx);
+          Slot::modifySignal(rawSignal);
+          Slot::commit();
+          // Update display
+          Display::printf(0, Display::Line::Navigation, F("<<EXIT SAVING REPEAT>"));
+          // Switch to saving state
+          state = State::Saving;
         }
         else
         {
-          // Loop to the left
-          editCharOffset = 0;
+          Display::printf(0, Display::Line::Line_5, F("No raw storage free"));
         }
-        editCharAllowedIdx = MenuItem::getCharAllowedIdx(newName[editCharOffset]);
-        // Switch to refresh state
-        state = State::Refresh;
       }
       break;
 
-    case Menu::Action::Back:
-      if (state == State::WaitInput)
+    default:
+      break;
+    }
+
+    if (state == State::Saving)
+    {
+      if (Slot::isPending() == false)
       {
-        if (editCharOffset > 0)
+        // Update display
+        Display::printf(0, Display::Line::Navigation, F("<<EXIT SAVED  REPEAT>"));
+        // Switch to saved state
+        state = State::Saved;
+      }
+    }
+
+    if (state == State::Searching)
+    {
+      if (Radio::readRawFrame(reader) == true)
+      {
+        Capture::stop();
+        packedSize = RawFrame::encode(reader.pulses, reader.pulsesCount, packedFrame);
+
+#ifdef LOG_DEBUG
+        Log::printf(F("Raw %u pulses: %u bytes"), reader.pulsesCount, packedSize);
+#endif // LOG_DEBUG
+
+        // Update display
+        Display::clear();
+        Display::printf(0, Display::Line::Header, F("Raw frame RX    "));
+        Display::printf(0, Display::Line::Line_1, F("Pulses: %u"), reader.pulsesCount);
+        if (packedSize > 0)
         {
-          // Shift cursor to the left
-          editCharOffset--;
+          Display::printf(0, Display::Line::Line_2, F("Packed: %u bytes"), packedSize);
+          Display::printf(0, Display::Line::Line_3, F("Raw: %u bytes"), (uint16_t)(reader.pulsesCount * sizeof(uint16_t)));
+          Display::printf(0, Display::Line::Navigation, F("<<EXIT REPEAT>/SAVE>>"));
+        }
+        else
+        {
+          Display::printf(0, Display::Line::Line_2, F("Too many timings"));
+          Display::printf(0, Display::Line::Navigation, F("<<EXIT REPEAT>"));
+        }
+
+        // Switch to found state
+        state = State::Found;
+      }
+    }
+
+    Menu::FunctionState functionState = (state == State::Disabled) ? Menu::FunctionState::Inactive
+                                                                   : Menu::FunctionState::Active;
+
+    return functionState;
+  }
+
+  /**
+   * @brief Slot name editing item's functionality callback
+   *
+   * @param action New menu action
+   * @param param Menu item's parameter
+   * @return Current menu item's function state
+   */
+  Menu::FunctionState slotEditNameCallback(Menu::Action action, int param)
+  {
+    enum class State
+    {
+      Disabled,
+      Refresh,
+      WaitInput,
+    };
+
+    static State state = State::Disabled;
+    static const char *currentName = nullptr;
+    static char newName[Slot::nameLengthMax + 1];
+    static uint8_t editCharOffset;
+    static uint8_t editCharAllowedIdx;
+    static bool isSaving = false;
+
+    // Handle new action
+    switch (action)
+    {
+    case Menu::Action::Exit:
+      if (state != State::Disabled)
+      {
+        Display::clear();
+        // Switch to disabled state
+        state = State::Disabled;
+      }
+      break;
+
+    case Menu::Action::Enter:
+      if (state == State::Disabled)
+      {
+        // Update display
+        Display::clear();
+        Display::printf(0, Display::Line::Header, F("Edit name       "));
+        // Copy current slot name
+        currentName = MenuItem::getSlotPageName(selectedSlotIdx);
+        snprintf_P(newName, sizeof(newName), PSTR("%-12s"), currentName);
+        editCharOffset = 0;
+        editCharAllowedIdx = Slot::getNameCharIdx(newName[editCharOffset]);
+        // Switch to refresh state
+        state = State::Refresh;
+      }
+      else if (state == State::WaitInput)
+      {
+        if (editCharOffset < Slot::nameLengthMax - 1)
+        {
+          // Shift cursor to the right
+          editCharOffset++;
+        }
+        else
+        {
+          // Loop to the left
+          editCharOffset = 0;
+        }
+        editCharAllowedIdx = Slot::getNameCharIdx(newName[editCharOffset]);
+        // Switch to refresh state
+        state = State::Refresh;
+      }
+      break;
+
+    case Menu::Action::Back:
+      if (state == State::WaitInput)
+      {
+        if (editCharOffset > 0)
+        {
+          // Shift cursor to the left
+          editCharOffset--;
         }
         else
         {
           // Loop to the right
           editCharOffset = Slot::nameLengthMax - 1;
         }
-        editCharAllowedIdx = MenuItem::getCharAllowedIdx(newName[editCharOffset]);
-        // Switch to refresh state
-        state = State::Refresh;
+        editCharAllowedIdx = Slot::getNameCharIdx(newName[editCharOffset]);
+        // Switch to refresh state
+        state = State::Refresh;
+      }
+      break;
+
+    case Menu::Action::Prev:
+      if (state == State::WaitInput)
+      {
+        if (editCharAllowedIdx > 0)
+        {
+          editCharAllowedIdx--;
+        }
+        else
+        {
+          editCharAllowedIdx = Slot::nameCharsCount - 1;
+        }
+        // Switch to refresh state
+        state = State::Refresh;
+      }
+      break;
+
+    case Menu::Action::Next:
+      if (state == State::WaitInput)
+      {
+        if (editCharAllowedIdx < Slot::nameCharsCount - 1)
+        {
+          editCharAllowedIdx++;
+        }
+        else
+        {
+          editCharAllowedIdx = 0;
+        }
+        // Switch to refresh state
+        state = State::Refresh;
+      }
+      break;
+
+    case Menu::Action::Set:
+      if (state == State::WaitInput)
+      {
+        bool isNotEqual = (strncmp(newName, currentName, strlen(newName)) != 0);
+        if (isNotEqual == true)
+        {
+          // Copy new slot name
+          snprintf_P(currentName, sizeof(MenuItem::slotPageNames[0]), PSTR("%-12s"), newName);
+          // Save new slot name on the storage in background
+          Slot::begin(selectedSlotIdx);
+          Slot::modifyName(newName);
+          Slot::commit();
+          Display::printf(0, Display::Line::Navigation, F("<<EXIT SAVING        "));
+          isSaving = true;
+        }
+      }
+      break;
+
+    default:
+      break;
+    }
+
+    if (state == State::Refresh)
+    {
+      // Update name
+      newName[editCharOffset] = Slot::getNameChar(editCharAllowedIdx);
+      Display::setSize(Display::Size::Font_8x16, true);
+      Display::printf(0, Display::Line::Line_2, newName);
+      Display::setInverted(true);
+      Display::printf(editCharOffset, Display::Line::Line_2, F("%c"), newName[editCharOffset]);
+      Display::setSize(Display::Size::Font_6x8, true);
+
+      bool isEqual = (strncmp(newName, currentName, strlen(newName)) == 0);
+      Display::printf(0, Display::Line::Navigation, isEqual ? F("<<EXIT               ") : F("<<EXIT         SAVE>>"));
+      isSaving = false;
+
+      // Switch to wait input state
+      state = State::WaitInput;
+    }
+
+    if (state == State::WaitInput && isSaving == true)
+    {
+      if (Slot::isPending() == false)
+      {
+        Display::printf(0, Display::Line::Navigation, F("<<EXIT SAVED         "));
+        isSaving = false;
+      }
+    }
+
+    Menu::FunctionState functionState = (state == State::Disabled) ? Menu::FunctionState::Inactive
+                                                                   : Menu::FunctionState::Active;
+
+    return functionState;
+  }
+
+  /**
+   * @brief Draw scan list entry if it is on the page of the selected one
+   *
+   * @param list Scan list
+   * @param idx Index of the entry to draw
+   * @param selectedIdx Index of the selected entry
+   */
+  void drawScanEntry(const Radio::ScanList &list, uint8_t idx, uint8_t selectedIdx)
+  {
+    if (idx / MainMenu::pageItemCount != selectedIdx / MainMenu::pageItemCount)
+    {
+      return;
+    }
+
+    Display::Line line = MainMenu::displayLines[idx % MainMenu::pageItemCount];
+    if (idx >= list.count)
+    {
+      Display::printf(0, line, F("%-20S"), PSTR(""));
+    }
+    else
+    {
+      Display::setInverted(idx == selectedIdx);
+      Display::printf(0, line, F("%08lX P%02u x%-6u"), list.signals[idx].value, list.signals[idx].protocol,
+                      list.hits[idx]);
+    }
+  }
+
+  /**
+   * @brief Draw page of the scan list with the selected entry
+   *
+   * @param list Scan list
+   * @param selectedIdx Index of the selected entry
+   */
+  void drawScanList(const Radio::ScanList &list, uint8_t selectedIdx)
+  {
+    uint8_t firstIdx = selectedIdx - (selectedIdx % MainMenu::pageItemCount);
+    for (uint8_t idx = firstIdx; idx < firstIdx + MainMenu::pageItemCount; idx++)
+    {
+      drawScanEntry(list, idx, selectedIdx);
+    }
+  }
+
+  /**
+   * @brief Slot scanning menu item's functionality callback
+   * Receiver is kept on and every distinct signal is listed with its frame count,
+   * the selected one can be saved to the slot
+   *
+   * @param action New menu action
+   * @param param Menu item's parameter
+   * @return Current menu item's function state
+   */
+  Menu::FunctionState slotScanCallback(Menu::Action action, int param)
+  {
+    enum class State
+    {
+      Disabled,
+      Scanning,
+      Saving,
+    };
+
+    static State state = State::Disabled;
+    static Radio::ScanList list;
+    static uint8_t selectedIdx = 0;
+
+    // Handle new action
+    switch (action)
+    {
+    case Menu::Action::Exit:
+      if (state != State::Disabled)
+      {
+        Display::clear();
+        // Disable receiver
+        Radio::disableReciever();
+        // Switch to disabled state
+        state = State::Disabled;
+      }
+      break;
+
+    case Menu::Action::Enter:
+      if (state == State::Disabled)
+      {
+        // Update display
+        Display::clear();
+        Display::printf(0, Display::Line::Header, F("Scanning...     "));
+        Display::printf(0, Display::Line::Line_1, F("Please wait"));
+        Display::printf(0, Display::Line::Navigation, F("<<EXIT"));
+        list.count = 0;
+        selectedIdx = 0;
+        // Enable radio receiver
+        Radio::enableReciever();
+        // Switch to scanning state
+        state = State::Scanning;
+      }
+      break;
+
+    case Menu::Action::Prev:
+    case Menu::Action::Next:
+      if (state != State::Disabled && list.count > 0)
+      {
+        // Browse the list like menu items
+        if (action == Menu::Action::Prev)
+        {
+          selectedIdx = (selectedIdx > 0) ? selectedIdx - 1 : list.count - 1;
+        }
+        else
+        {
+          selectedIdx = (selectedIdx + 1 < list.count) ? selectedIdx + 1 : 0;
+        }
+        drawScanList(list, selectedIdx);
+        Display::printf(7, Display::Line::Navigation, F("%2u/%-2u"), selectedIdx + 1, list.count);
+      }
+      break;
+
+    case Menu::Action::Set:
+      if (state == State::Scanning && list.count > 0)
+      {
+        // Set signal to current selected slot, it is saved on the storage in background
+        Slot::begin(selectedSlotIdx);
+        Slot::modifySignal(list.signals[selectedIdx]);
+        Slot::commit();
+        // Update display
+        Display::printf(0, Display::Line::Navigation, F("<<EXIT %2u/%-2u SAVING "), selectedIdx + 1, list.count);
+        // Switch to saving state
+        state = State::Saving;
+      }
+      break;
+
+    default:
+      break;
+    }
+
+    if (state == State::Saving)
+    {
+      if (Slot::isPending() == false)
+      {
+        // Update display
+        Display::printf(0, Display::Line::Navigation, F("<<EXIT %2u/%-2u SAVED  "), selectedIdx + 1, list.count);
+        // Switch back to scanning state
+        state = State::Scanning;
+      }
+    }
+
+    if (state != State::Disabled)
+    {
+      Slot::Signal rxSignal;
+      bool isSignalRead = Radio::readSignal(rxSignal);
+      if (isSignalRead == true)
+      {
+#ifdef LOG_DEBUG
+        Log::printf(F("Rx %02u: %u/%u"), rxSignal.protocol, rxSignal.value, rxSignal.bitLength);
+#endif // LOG_DEBUG
+
+        uint8_t listCount = list.count;
+        uint8_t idx = Radio::addScanHit(list, rxSignal);
+
+        // Update display, only the counted entry while the list doesn't grow,
+        // so redrawing doesn't miss the repeated frames
+        drawScanEntry(list, idx, selectedIdx);
+        if (list.count != listCount)
+        {
+          Display::printf(0, Display::Line::Header, F("Scan: %u signals"), list.count);
+          if (state == State::Scanning)
+          {
+            Display::printf(0, Display::Line::Navigation, F("<<EXIT %2u/%-2u  SAVE>>"), selectedIdx + 1, list.count);
+          }
+        }
+      }
+    }
+
+    Menu::FunctionState functionState = (state == State::Disabled) ? Menu::FunctionState::Inactive
+                                                                   : Menu::FunctionState::Active;
+
+    return functionState;
+  }
+
+  /**
+   * @brief Signal monitor menu item's functionality callback
+   * Received signals are listed with names of the slots they are saved in
+   *
+   * @param action New menu action
+   * @param param Menu item's parameter
+   * @return Current menu item's function state
+   */
+  Menu::FunctionState monitorCallback(Menu::Action action, int param)
+  {
+    enum class State
+    {
+      Disabled,
+      Monitoring,
+    };
+
+    // Time to ignore repeated frames of the same signal, milliseconds
+    constexpr unsigned long repeatTimeMs = 1000;
+
+    static State state = State::Disabled;
+    // Received signals, the newest one is the first
+    static Slot::Signal rxSignals[MainMenu::pageItemCount];
+    static uint8_t rxSlotIdxs[MainMenu::pageItemCount];
+    static uint8_t rxCount = 0;
+    static unsigned long lastRxTimeMs = 0;
+
+    // Handle new action
+    switch (action)
+    {
+    case Menu::Action::Exit:
+      if (state != State::Disabled)
+      {
+        Display::clear();
+        // Disable receiver
+        Radio::disableReciever();
+        // Switch to disabled state
+        state = State::Disabled;
+      }
+      break;
+
+    case Menu::Action::Enter:
+      if (state == State::Disabled)
+      {
+        // Update display
+        Display::clear();
+        Display::printf(0, Display::Line::Header, F("Monitor         "));
+        Display::printf(0, Display::Line::Line_1, F("Please wait"));
+        Display::printf(0, Display::Line::Navigation, F("<<EXIT"));
+        rxCount = 0;
+        // Enable radio receiver
+        Radio::enableReciever();
+        // Switch to monitoring state
+        state = State::Monitoring;
+      }
+      break;
+
+    default:
+      break;
+    }
+
+    if (state == State::Monitoring)
+    {
+      Slot::Signal rxSignal;
+      bool isSignalRead = Radio::readSignal(rxSignal);
+      if (isSignalRead == true)
+      {
+        unsigned long currentTimeMs = Hal::Clock::millis();
+        bool isRepeat = (rxCount > 0 && rxSignals[0] == rxSignal &&
+                         currentTimeMs - lastRxTimeMs < repeatTimeMs);
+        lastRxTimeMs = currentTimeMs;
+
+        if (isRepeat == false)
+        {
+          // Shift older signals down
+          if (rxCount < MainMenu::pageItemCount)
+          {
+            rxCount++;
+          }
+          for (uint8_t idx = rxCount - 1; idx > 0; idx--)
+          {
+            rxSignals[idx] = rxSignals[idx - 1];
+            rxSlotIdxs[idx] = rxSlotIdxs[idx - 1];
+          }
+          rxSignals[0] = rxSignal;
+          rxSlotIdxs[0] = Slot::findSignal(rxSignal);
+
+          // Update display
+          for (uint8_t idx = 0; idx < rxCount; idx++)
+          {
+            char label[Slot::nameLengthMax + 1];
+            if (rxSlotIdxs[idx] != Slot::invalidIdx)
+            {
+              Slot::getName(rxSlotIdxs[idx], label);
+            }
+            else
+            {
+              strncpy_P(label, PSTR("Unknown"), sizeof(label));
+            }
+            Display::printf(0, MainMenu::displayLines[idx], F("%-11.11s %08lX"), label, rxSignals[idx].value);
+          }
+        }
+      }
+    }
+
+    Menu::FunctionState functionState = (state == State::Disabled) ? Menu::FunctionState::Inactive
+                                                                   : Menu::FunctionState::Active;
+
+    return functionState;
+  }
+
+  /**
+   * @brief Sequence menu item's functionality callback
+   * Sends every slot with a saved signal in order, raw frames included, while the screen shows the progress
+   *
+   * @param action New menu action
+   * @param param Menu item's parameter
+   * @return Current menu item's function state
+   */
+  Menu::FunctionState sequenceCallback(Menu::Action action, int param)
+  {
+    enum class State
+    {
+      Disabled,
+      Sending,
+      Done,
+    };
+
+    // Frames sent per slot
+    constexpr uint8_t repeatCount = 10;
+    // Silence between slots, milliseconds
+    constexpr uint16_t gapMs = 500;
+    // Period of the progress update, milliseconds
+    constexpr unsigned long progressUpdatePeriodMs = 250;
+
+    static State state = State::Disabled;
+    static uint8_t nextSlotIdx = 0;
+    static uint8_t queuedCount = 0;
+    static uint16_t txFramesStart = 0;
+    static unsigned long lastUpdateTimeMs = 0;
+
+    // Handle new action
+    switch (action)
+    {
+    case Menu::Action::Exit:
+      if (state != State::Disabled)
+      {
+        // Drop slots not sent yet
+        Transmitter::stop();
+        Display::clear();
+        // Switch to disabled state
+        state = State::Disabled;
+      }
+      break;
+
+    case Menu::Action::Enter:
+      if (state == State::Disabled)
+      {
+        // Update display
+        Display::clear();
+        Display::printf(0, Display::Line::Header, F("Sequence        "));
+        Display::printf(0, Display::Line::Line_1, F("Frames: %u per slot"), repeatCount);
+        Display::printf(0, Display::Line::Line_2, F("Gap: %u ms"), gapMs);
+        Display::printf(0, Display::Line::Navigation, F("<<EXIT"));
+        nextSlotIdx = 0;
+        queuedCount = 0;
+        txFramesStart = Transmitter::getFramesSent();
+        lastUpdateTimeMs = Hal::Clock::millis() - progressUpdatePeriodMs;
+        // Switch to sending state
+        state = State::Sending;
+      }
+      break;
+
+    default:
+      break;
+    }
+
+    if (state == State::Sending)
+    {
+      // Queue the next slot when there is room, one slot per call keeps the menu responsive
+      if (nextSlotIdx < Slot::slotsCount && Transmitter::getQueuedCount() < Transmitter::queueSize)
+      {
+        Slot::Signal signal;
+        Slot::getSignal(nextSlotIdx, signal);
+        bool isQueued = false;
+        if (Slot::isRaw(signal) == true)
+        {
+          // Raw frame is unpacked to a waveform, the queue keeps its own copy of it
+          uint8_t packedFrame[Slot::rawFrameSizeMax];
+          Transmitter::Waveform waveform;
+          isQueued = (Slot::loadRawFrame(signal, packedFrame) == true &&
+                      RawFrame::decode(packedFrame, waveform) == true &&
+                      Transmitter::enqueue(waveform, repeatCount, gapMs) == true);
+        }
+        else if ((signal == Slot::signalInvalid) == false)
+        {
+          isQueued = Transmitter::enqueue(signal, repeatCount, gapMs);
+        }
+        if (isQueued == true)
+        {
+          queuedCount++;
+        }
+        nextSlotIdx++;
+      }
+
+      bool isDone = (nextSlotIdx == Slot::slotsCount && Transmitter::isBusy() == false);
+      unsigned long currentTimeMs = Hal::Clock::millis();
+      if (isDone == true || currentTimeMs - lastUpdateTimeMs >= progressUpdatePeriodMs)
+      {
+        lastUpdateTimeMs = currentTimeMs;
+        uint8_t sentCount = queuedCount - Transmitter::getQueuedCount();
+        Display::printf(0, Display::Line::Line_3, F("Slots: %u/%u"), sentCount, queuedCount);
+        Display::printf(0, Display::Line::Line_4, F("Sent: %u frames"), Transmitter::getFramesSent() - txFramesStart);
+      }
+
+      if (isDone == true)
+      {
+        Display::printf(0, Display::Line::Header, (queuedCount > 0) ? F("Sequence done   ") : F("No signal saved "));
+        // Switch to done state
+        state = State::Done;
+      }
+    }
+
+    Menu::FunctionState functionState = (state == State::Disabled) ? Menu::FunctionState::Inactive
+                                                                   : Menu::FunctionState::Active;
+
+    return functionState;
+  }
+
+  /**
+   * @brief System information menu item's functionality callback
+   *
+   * @param action New menu action
+   * @param param Menu item's parameter
+   * @return Current menu item's function state
+   */
+  Menu::FunctionState systemCallback(Menu::Action action, int param)
+  {
+    enum class State
+    {
+      Disabled,
+      ShowInfo,
+    };
+
+    static State state = State::Disabled;
+    static unsigned long lastUpdateTimeMs = 0;
+
+    // Handle new action
+    switch (action)
+    {
+    case Menu::Action::Exit:
+      if (state != State::Disabled)
+      {
+        Display::clear();
+        // Switch to disabled state
+        state = State::Disabled;
       }
       break;
 
-    case Menu::Action::Prev:
-      if (state == State::WaitInput)
+    case Menu::Action::Enter:
+      if (state == State::Disabled)
       {
-        if (editCharAllowedIdx > 0)
+        // Update display
+        Display::clear();
+        MainMenu::showSystemInfo(PSTR("System info"));
+        Display::printf(0, Display::Line::Navigation, F("<<EXIT"));
+        lastUpdateTimeMs = Hal::Clock::millis();
+        // Switch to show info state
+        state = State::ShowInfo;
+      }
+      break;
+
+    default:
+      break;
+    }
+
+    if (state == State::ShowInfo)
+    {
+      unsigned long currentTimeMs = Hal::Clock::millis();
+      if (currentTimeMs > lastUpdateTimeMs + MainMenu::systemInfoUpdatePeriodMs)
+      {
+        lastUpdateTimeMs = currentTimeMs;
+
+        uint16_t batteryVoltage = Battery::readVoltage();
+        Display::printf(0, Display::Line::Line_3, F("Battery: %4umV"), batteryVoltage);
+      }
+    }
+
+    Menu::FunctionState functionState = (state == State::Disabled) ? Menu::FunctionState::Inactive
+                                                                   : Menu::FunctionState::Active;
+
+    return functionState;
+  }
+
+  /**
+   * @brief Raw capture menu item's functionality callback
+   * Shows the edge rate and pulse length range of everything on the band, decoded or not
+   *
+   * @param action New menu action
+   * @param param Menu item's parameter
+   * @return Current menu item's function state
+   */
+  Menu::FunctionState captureCallback(Menu::Action action, int param)
+  {
+    enum class State
+    {
+      Disabled,
+      Capturing,
+    };
+
+    // Statistics window, milliseconds
+    constexpr unsigned long windowTimeMs = 1000;
+
+    static State state = State::Disabled;
+    static unsigned long windowStartTimeMs = 0;
+    static unsigned long edgesCount = 0;
+    static uint16_t durationMinUs = Capture::durationMaxUs;
+    static uint16_t durationMaxUs = 0;
+
+    // Handle new action
+    switch (action)
+    {
+    case Menu::Action::Exit:
+      if (state != State::Disabled)
+      {
+        Capture::stop();
+        Display::clear();
+        // Switch to disabled state
+        state = State::Disabled;
+      }
+      break;
+
+    case Menu::Action::Enter:
+      if (state == State::Disabled)
+      {
+        // Update display
+        Display::clear();
+        Display::printf(0, Display::Line::Header, F("Raw capture     "));
+        Display::printf(0, Display::Line::Line_1, F("Please wait"));
+        Display::printf(0, Display::Line::Navigation, F("<<EXIT"));
+        edgesCount = 0;
+        durationMinUs = Capture::durationMaxUs;
+        durationMaxUs = 0;
+        windowStartTimeMs = Hal::Clock::millis();
+        // Capture owns the receiver interrupt
+        Capture::start(Radio::rxInterrupt, Radio::rxPin);
+        // Switch to capturing state
+        state = State::Capturing;
+      }
+      break;
+
+    default:
+      break;
+    }
+
+    if (state == State::Capturing)
+    {
+      // Drain all buffered edges in batches
+      uint16_t edges[Radio::captureBatchSize];
+      uint8_t count;
+      do
+      {
+        count = Capture::read(edges, Radio::captureBatchSize);
+        for (uint8_t idx = 0; idx < count; idx++)
         {
-          editCharAllowedIdx--;
+          uint16_t durationUs = Capture::getDuration(edges[idx]);
+          if (durationUs < durationMinUs)
+          {
+            durationMinUs = durationUs;
+          }
+          if (durationUs > durationMaxUs)
+          {
+            durationMaxUs = durationUs;
+          }
+        }
+        edgesCount += count;
+      } while (count == Radio::captureBatchSize);
+
+      unsigned long currentTimeMs = Hal::Clock::millis();
+      if (currentTimeMs - windowStartTimeMs >= windowTimeMs)
+      {
+        // Update display
+        Display::printf(0, Display::Line::Line_1, F("Edges: %lu/s"), edgesCount * 1000UL / (currentTimeMs - windowStartTimeMs));
+        if (edgesCount > 0)
+        {
+          Display::printf(0, Display::Line::Line_2, F("Pulse:%5u-%-5uus"), durationMinUs, durationMaxUs);
         }
         else
         {
-          editCharAllowedIdx = strlen(MenuItem::allowedChars) - 1;
+          Display::printf(0, Display::Line::Line_2, F("No edges            "));
         }
-        // Switch to refresh state
-        state = State::Refresh;
+        Display::printf(0, Display::Line::Line_3, F("Overflow: %u"), Capture::getOverflowCount());
+
+        windowStartTimeMs = currentTimeMs;
+        edgesCount = 0;
+        durationMinUs = Capture::durationMaxUs;
+        durationMaxUs = 0;
+      }
+    }
+
+    Menu::FunctionState functionState = (state == State::Disabled) ? Menu::FunctionState::Inactive
+                                                                   : Menu::FunctionState::Active;
+
+    return functionState;
+  }
+
+  /**
+   * @brief Draw protocol line if it is on the page of the selected one
+   *
+   * @param protocol Protocol number
+   * @param selectedProtocol Number of the selected protocol
+   */
+  void drawProtocol(uint8_t protocol, uint8_t selectedProtocol)
+  {
+    uint8_t idx = protocol - 1;
+    uint8_t selectedIdx = selectedProtocol - 1;
+    if (idx / MainMenu::pageItemCount != selectedIdx / MainMenu::pageItemCount)
+    {
+      return;
+    }
+
+    Display::Line line = MainMenu::displayLines[idx % MainMenu::pageItemCount];
+    if (protocol > Protocol::count)
+    {
+      Display::printf(0, line, F("%-20S"), PSTR(""));
+    }
+    else
+    {
+      bool isEnabled = (Receiver::getProtocolMask() & (1U << idx)) != 0;
+      Receiver::ProtocolStats stats;
+      Receiver::getStats(protocol, stats);
+      Display::setInverted(protocol == selectedProtocol);
+      Display::printf(0, line, F("P%02u %-3S %5u/%-6u"), protocol, (isEnabled == true) ? PSTR("on") : PSTR("off"),
+                      stats.decodes, stats.attempts);
+    }
+  }
+
+  /**
+   * @brief Draw page of the protocol list with the selected protocol
+   *
+   * @param selectedProtocol Number of the selected protocol
+   */
+  void drawProtocols(uint8_t selectedProtocol)
+  {
+    uint8_t firstProtocol = selectedProtocol - ((selectedProtocol - 1) % MainMenu::pageItemCount);
+    for (uint8_t protocol = firstProtocol; protocol < firstProtocol + MainMenu::pageItemCount; protocol++)
+    {
+      drawProtocol(protocol, selectedProtocol);
+    }
+  }
+
+  /**
+   * @brief Protocols menu item's functionality callback
+   * Lists protocols tried by the receiver with their decoded/tried frame counters,
+   * the selected protocol is switched on or off and the set is saved on the storage
+   *
+   * @param action New menu action
+   * @param param Menu item's parameter
+   * @return Current menu item's function state
+   */
+  Menu::FunctionState protocolsCallback(Menu::Action action, int param)
+  {
+    enum class State
+    {
+      Disabled,
+      Listing,
+    };
+
+    // Counters refresh period, milliseconds
+    constexpr unsigned long refreshTimeMs = 1000;
+
+    static State state = State::Disabled;
+    static uint8_t selectedProtocol = 1;
+    static unsigned long refreshTimeStartMs = 0;
+
+    // Handle new action
+    switch (action)
+    {
+    case Menu::Action::Exit:
+      if (state != State::Disabled)
+      {
+        Display::clear();
+        // Disable receiver
+        Radio::disableReciever();
+        // Switch to disabled state
+        state = State::Disabled;
+      }
+      break;
+
+    case Menu::Action::Enter:
+      if (state == State::Disabled)
+      {
+        selectedProtocol = 1;
+        // Update display
+        Display::clear();
+        Display::printf(0, Display::Line::Header, F("Protocols       "));
+        drawProtocols(selectedProtocol);
+        Display::printf(0, Display::Line::Navigation, F("<<EXIT %2u/%-2u  SET>>"), selectedProtocol, Protocol::count);
+        refreshTimeStartMs = Hal::Clock::millis();
+        // Receiver keeps counting frames while the list is shown
+        Radio::enableReciever();
+        // Switch to listing state
+        state = State::Listing;
       }
       break;
 
+    case Menu::Action::Prev:
     case Menu::Action::Next:
-      if (state == State::WaitInput)
+      if (state == State::Listing)
       {
-        if (editCharAllowedIdx < strlen(MenuItem::allowedChars) - 1)
+        // Browse the list like menu items
+        if (action == Menu::Action::Prev)
         {
-          editCharAllowedIdx++;
+          selectedProtocol = (selectedProtocol > 1) ? selectedProtocol - 1 : Protocol::count;
         }
         else
         {
-          editCharAllowedIdx = 0;
+          selectedProtocol = (selectedProtocol < Protocol::count) ? selectedProtocol + 1 : 1;
         }
-        // Switch to refresh state
-        state = State::Refresh;
+        drawProtocols(selectedProtocol);
+        Display::printf(7, Display::Line::Navigation, F("%2u/%-2u"), selectedProtocol, Protocol::count);
       }
       break;
 
     case Menu::Action::Set:
-      if (state == State::WaitInput)
+      if (state == State::Listing)
       {
-        bool isNotEqual = (strncmp(newName, currentName, strlen(newName)) != 0);
-        if (isNotEqual == true)
-        {
-          // Copy new slot name
-          snprintf(currentName, sizeof(MenuItem::slotNameList[0]), "%-12s", newName);
-          // Save new slot name on the storage
-          Slot::setName(selectedSlotIdx, newName);
-          Display::printf(0, Display::Line::Navigation, "<<EXIT               ");
-        }
+        // Switch selected protocol and save the set
+        Slot::Settings settings;
+        Slot::getSettings(settings);
+        settings.protocolMask = Receiver::getProtocolMask() ^ (1U << (selectedProtocol - 1));
+        Receiver::setProtocolMask(settings.protocolMask);
+        Slot::setSettings(settings);
+        // Update display
+        drawProtocol(selectedProtocol, selectedProtocol);
       }
       break;
 
@@ -713,21 +2068,19 @@ namespace
       break;
     }
 
-    if (state == State::Refresh)
+    if (state == State::Listing)
     {
-      // Update name
-      newName[editCharOffset] = MenuItem::allowedChars[editCharAllowedIdx];
-      Display::setSize(Display::Size::Font_8x16, true);
-      Display::printf(0, Display::Line::Line_2, newName);
-      Display::setInverted(true);
-      Display::printf(editCharOffset, Display::Line::Line_2, "%c", newName[editCharOffset]);
-      Display::setSize(Display::Size::Font_6x8, true);
+      // Signals are only counted here
+      Slot::Signal rxSignal;
+      Radio::readSignal(rxSignal);
 
-      bool isEqual = (strncmp(newName, currentName, strlen(newName)) == 0);
-      Display::printf(0, Display::Line::Navigation, isEqual ? "<<EXIT               " : "<<EXIT         SAVE>>");
-
-      // Switch to wait input state
-      state = State::WaitInput;
+      unsigned long currentTimeMs = Hal::Clock::millis();
+      if (currentTimeMs - refreshTimeStartMs >= refreshTimeMs)
+      {
+        // Update display
+        drawProtocols(selectedProtocol);
+        refreshTimeStartMs = currentTimeMs;
+      }
     }
 
     Menu::FunctionState functionState = (state == State::Disabled) ? Menu::FunctionState::Inactive
@@ -737,22 +2090,56 @@ namespace
   }
 
   /**
-   * @brief System information menu item's functionality callback
+   * @brief Draw bar graph line of the level width class
+   *
+   * @param line Display line
+   * @param label Class label in program memory, padded to the bar offset
+   * @param count Class edges in the window
+   * @param edgesCount All edges in the window
+   */
+  void drawBandBar(Display::Line line, const __FlashStringHelper *label, uint16_t count, uint16_t edgesCount)
+  {
+    // Bar width, characters
+    constexpr uint8_t barWidthMax = 10;
+    constexpr uint8_t barOffset = 5;
+
+    uint8_t percent = (edgesCount > 0) ? (uint32_t)count * 100 / edgesCount : 0;
+    // Any edge of the class is shown
+    uint8_t barWidth = (count > 0) ? ((uint32_t)count * barWidthMax + edgesCount - 1) / edgesCount : 0;
+
+    Display::printf(0, line, label);
+    if (barWidth > 0)
+    {
+      Display::setInverted(true);
+      Display::printf(barOffset, line, F("%*S"), barWidth, PSTR(""));
+    }
+    Display::printf(barOffset + barWidth, line, F("%*S%4u%%"), barWidthMax - barWidth, PSTR(""), percent);
+  }
+
+  /**
+   * @brief Band monitor menu item's functionality callback
+   * Shows the RX edge rate and the bar graph of the level widths, decoded or not
    *
    * @param action New menu action
    * @param param Menu item's parameter
    * @return Current menu item's function state
    */
-  Menu::FunctionState systemCallback(Menu::Action action, int param)
+  Menu::FunctionState bandCallback(Menu::Action action, int param)
   {
     enum class State
     {
       Disabled,
-      ShowInfo,
+      Monitoring,
     };
 
+    // Counting window, milliseconds
+    constexpr unsigned long windowTimeMs = 500;
+    // Level width class labels
+    // Labels are padded to the bar offset
+    static const char classLabels[Band::classesCount][6] PROGMEM = {"<150u", "<600u", "<2m  ", "<10m ", "10m+ "};
+
     static State state = State::Disabled;
-    static unsigned long lastUpdateTimeMs = 0;
+    static unsigned long windowStartTimeMs = 0;
 
     // Handle new action
     switch (action)
@@ -760,6 +2147,7 @@ namespace
     case Menu::Action::Exit:
       if (state != State::Disabled)
       {
+        Band::stop();
         Display::clear();
         // Switch to disabled state
         state = State::Disabled;
@@ -771,11 +2159,14 @@ namespace
       {
         // Update display
         Display::clear();
-        MainMenu::showSystemInfo("System info");
-        Display::printf(0, Display::Line::Navigation, "<<EXIT");
-        lastUpdateTimeMs = millis();
-        // Switch to show info state
-        state = State::ShowInfo;
+        Display::printf(0, Display::Line::Header, F("Band monitor    "));
+        Display::printf(0, Display::Line::Line_1, F("Please wait"));
+        Display::printf(0, Display::Line::Navigation, F("<<EXIT"));
+        windowStartTimeMs = Hal::Clock::millis();
+        // Band monitor owns the receiver interrupt
+        Band::start(Radio::rxInterrupt);
+        // Switch to monitoring state
+        state = State::Monitoring;
       }
       break;
 
@@ -783,15 +2174,24 @@ namespace
       break;
     }
 
-    if (state == State::ShowInfo)
+    if (state == State::Monitoring)
     {
-      unsigned long currentTimeMs = millis();
-      if (currentTimeMs > lastUpdateTimeMs + MainMenu::systemInfoUpdatePeriodMs)
+      unsigned long currentTimeMs = Hal::Clock::millis();
+      if (currentTimeMs - windowStartTimeMs >= windowTimeMs)
       {
-        lastUpdateTimeMs = currentTimeMs;
+        Band::Window window;
+        Band::read(window);
+        windowStartTimeMs = currentTimeMs;
 
-        uint16_t batteryVoltage = Battery::readVoltage();
-        Display::printf(0, Display::Line::Line_3, "Battery: %4umV", batteryVoltage);
+        // Update display
+        unsigned long edgesRate = (window.durationMs > 0) ? window.edgesCount * 1000UL / window.durationMs : 0;
+        Display::printf(0, Display::Line::Header, F("Band %6lu/s"), edgesRate);
+        for (uint8_t widthClass = 0; widthClass < Band::classesCount; widthClass++)
+        {
+          Display::Line line = (Display::Line)((uint8_t)Display::Line::Line_1 + widthClass);
+          drawBandBar(line, reinterpret_cast<const __FlashStringHelper *>(classLabels[widthClass]),
+                      window.counts[widthClass], window.edgesCount);
+        }
       }
     }
 
@@ -805,11 +2205,11 @@ namespace
 void setup()
 {
   // Initialize serial port for logs
-  Serial.begin(115200);
+  Hal::Serial::initialize(115200);
 
 #ifdef LOG_DEBUG
   // Log FW version info
-  Log::printf("Firmware: v%d.%d", FwVersion::major, FwVersion::minor);
+  Log::printf(F("Firmware: v%d.%d"), FwVersion::major, FwVersion::minor);
 #endif // LOG_DEBUG
 
   // Initialize battery voltage readings
@@ -818,7 +2218,7 @@ void setup()
 #ifdef LOG_DEBUG
   // Log battery info
   uint16_t batteryVoltage = Battery::readVoltage();
-  Log::printf("Battery: %4u", batteryVoltage);
+  Log::printf(F("Battery: %4u"), batteryVoltage);
 #endif // LOG_DEBUG
 
   // Initialize display
@@ -826,7 +2226,9 @@ void setup()
 
   // Show welcome screen
   MainMenu::showSystemInfo(MainMenu::rootHeaderString);
-  unsigned long welcomeEndTimeMs = millis() + MainMenu::welcomeTimeMs;
+  unsigned long welcomeEndTimeMs = Hal::Clock::millis() + MainMenu::welcomeTimeMs;
+  // Screen transfers would add up to the measured initialization times
+  Display::flush();
 
   // Initialize buttons
   Button::initialize();
@@ -834,20 +2236,33 @@ void setup()
   // Initialize radio
   Radio::initialize();
 
+  // Initialize slots storage
+  unsigned long startTimeUs = Hal::Clock::micros();
+  Slot::initialize();
+  Hal::Profile::report(F("Slots init"), Hal::Clock::micros() - startTimeUs);
+
+  Slot::Settings settings;
+  Slot::getSettings(settings);
+  Receiver::setProtocolMask(settings.protocolMask);
+
   // Erase all slots on the storage
   // Slot::eraseStorage();
 
-  // Setup slot menu items with slot data
-  MenuItem::setupSlots();
+  // Load the first page of slot names, their journal records are CRC-checked on this first read
+  startTimeUs = Hal::Clock::micros();
+  MenuItem::loadSlotPage(0);
+  Hal::Profile::report(F("Slots page"), Hal::Clock::micros() - startTimeUs);
+
+  Menu::initialize(MenuItem::items);
 
   // Wait until welcome screen time ends
-  while (millis() < welcomeEndTimeMs)
+  while (Hal::Clock::millis() < welcomeEndTimeMs)
   {
-    delay(1);
+    Hal::Clock::delay(1);
   }
 
   // Draw current menu initially
-  drawMenu(pCurrentMenu);
+  drawMenu(Menu::Action::None);
 }
 
 void loop()
@@ -856,7 +2271,7 @@ void loop()
   if (buttonId != Button::Id::None)
   {
 #ifdef LOG_DEBUG
-    Log::printf("UP:%u DOWN:%u LEFT:%u RIGHT:%u",
+    Log::printf(F("UP:%u DOWN:%u LEFT:%u RIGHT:%u"),
                 Button::getState(Button::Id::Up), Button::getState(Button::Id::Down),
                 Button::getState(Button::Id::Left), Button::getState(Button::Id::Right));
 #endif // LOG_DEBUG
@@ -865,15 +2280,14 @@ void loop()
   // Get menu action according to the button event
   Menu::Action menuAction = getMenuAction(buttonId);
 
-  const Menu::Item *pNewMenu = Menu::process(pCurrentMenu, menuAction);
-  if (pNewMenu != nullptr)
+  if (Menu::process(menuAction) == true)
   {
-    if (pNewMenu != pCurrentMenu)
-    {
-      pCurrentMenu = pNewMenu;
-    }
-
     // Draw new menu
-    drawMenu(pCurrentMenu);
+    drawMenu(menuAction);
+  }
+  else if (menuAction != Menu::Action::None)
+  {
+    // Item function has taken the action and may draw over the menu
+    isMenuDrawn = false;
   }
 }
@@ -0,0 +1,44 @@
+#include "protocol.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hal.h"
+
+using namespace Protocol;
+
+namespace
+{
+    const Timing timings[count] PROGMEM = {
+        {350, {1, 31}, {1, 3}, {3, 1}, false},       // 1
+        {650, {1, 10}, {1, 2}, {2, 1}, false},       // 2
+        {100, {30, 71}, {4, 11}, {9, 6}, false},     // 3
+        {380, {1, 6}, {1, 3}, {3, 1}, false},        // 4
+        {500, {6, 14}, {1, 2}, {2, 1}, false},       // 5
+        {450, {23, 1}, {1, 2}, {2, 1}, true},        // 6 (HT6P20B)
+        {150, {2, 62}, {1, 6}, {6, 1}, false},       // 7 (HS2303-PT)
+        {200, {3, 130}, {7, 16}, {3, 16}, false},    // 8 (Conrad RS-200 RX)
+        {200, {130, 7}, {16, 7}, {16, 3}, true},     // 9 (Conrad RS-200 TX)
+        {365, {18, 1}, {3, 1}, {1, 3}, true},        // 10 (1ByOne doorbell)
+        {270, {36, 1}, {1, 2}, {2, 1}, true},        // 11 (HT12E)
+        {320, {36, 1}, {1, 2}, {2, 1}, true},        // 12 (SM5212)
+    };
+} // namespace
+
+/**
+ * @brief Read protocol timing
+ *
+ * @param protocol Protocol number
+ * @param timing Object to copy the timing
+ * @return true if protocol is known, false otherwise
+ */
+bool Protocol::getTiming(uint8_t protocol, Timing &timing)
+{
+    if (protocol == 0 || protocol > count)
+    {
+        return false;
+    }
+
+    memcpy_P(&timing, &timings[protocol - 1], sizeof(Timing));
+    return true;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Radio protocol timings, same as the rc-switch library protocol table
+ *
+ * Every bit and the sync are sent as a pulse pair: the first level for the high factor
+ * and the second level for the low factor of the pulse length. The first level is high,
+ * or low for the inverted protocols. Data bits are sent MSB first, the sync follows them.
+ */
+namespace Protocol
+{
+    // Number of protocols, protocol numbers are 1 .. count
+    static constexpr uint8_t count = 12;
+
+    /**
+     * @brief Pulse pair as multiples of the pulse length
+     */
+    struct Pulses
+    {
+        uint8_t high;
+        uint8_t low;
+    };
+
+    /**
+     * @brief Protocol timing
+     */
+    struct Timing
+    {
+        uint16_t pulseLength; // Microseconds
+        Pulses sync;
+        Pulses zero;
+        Pulses one;
+        bool isInverted;
+    };
+
+    /**
+     * @brief Read protocol timing
+     *
+     * @param protocol Protocol number
+     * @param timing Object to copy the timing
+     * @return true if protocol is known, false otherwise
+     */
+    bool getTiming(uint8_t protocol, Timing &timing);
+} // namespace Protocol
@@ -0,0 +1,357 @@
+#include "raw_frame.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+using namespace RawFrame;
+
+namespace
+{
+    constexpr uint8_t headerSize = 2;
+    // Sorted durations start a new symbol on the jump over 1/2^shift of the previous duration,
+    // jump threshold is doubled until the symbols fit
+    constexpr uint8_t jumpShiftMax = 3;
+    constexpr uint8_t runMax = (1 << runBits) + 1;
+
+    static_assert(headerSize + symbolsMax * sizeof(uint16_t) + pairsMax < packedSizeMax);
+
+    /**
+     * @brief Bit stream position
+     */
+    struct BitStream
+    {
+        uint8_t *data;
+        uint16_t bitPos;
+        uint16_t bitsCount;
+        bool isOverflow;
+    };
+
+    /**
+     * @brief Append bits to the stream, LSB first
+     *
+     * @param stream Stream to write
+     * @param value Bits value
+     * @param count Number of bits
+     */
+    void writeBits(BitStream &stream, uint8_t value, uint8_t count)
+    {
+        for (uint8_t bit = 0; bit < count; bit++, stream.bitPos++)
+        {
+            if (stream.bitPos >= stream.bitsCount)
+            {
+                stream.isOverflow = true;
+                return;
+            }
+
+            uint8_t &byte = stream.data[stream.bitPos / 8];
+            if ((stream.bitPos % 8) == 0)
+            {
+                byte = 0;
+            }
+            if ((value >> bit) & 1)
+            {
+                byte |= 1 << (stream.bitPos % 8);
+            }
+        }
+    }
+
+    /**
+     * @brief Read bits from the stream, LSB first
+     *
+     * @param stream Stream to read
+     * @param count Number of bits
+     * @return Bits value, 0 if stream is over (isOverflow is set)
+     */
+    uint8_t readBits(BitStream &stream, uint8_t count)
+    {
+        uint8_t value = 0;
+        for (uint8_t bit = 0; bit < count; bit++, stream.bitPos++)
+        {
+            if (stream.bitPos >= stream.bitsCount)
+            {
+                stream.isOverflow = true;
+                return 0;
+            }
+
+            if ((stream.data[stream.bitPos / 8] >> (stream.bitPos % 8)) & 1)
+            {
+                value |= 1 << bit;
+            }
+        }
+
+        return value;
+    }
+
+    /**
+     * @brief Return number of bits to store index
+     *
+     * @param count Number of index values
+     */
+    uint8_t getIndexBits(uint8_t count)
+    {
+        uint8_t bits = 0;
+        while ((1U << bits) < count)
+        {
+            bits++;
+        }
+
+        return bits;
+    }
+
+    /**
+     * @brief Split sorted durations into symbols
+     *
+     * @param sorted Durations in ascending order
+     * @param count Number of durations
+     * @param jumpShift Jump threshold shift
+     * @param symbolMaxUs Buffer for the longest duration of each symbol (symbolsMax size)
+     * @param symbolSums Buffer for the durations sum of each symbol (symbolsMax size)
+     * @param symbolCounts Buffer for the durations count of each symbol (symbolsMax size)
+     * @return Number of symbols, 0 if more than symbolsMax are needed
+     */
+    uint8_t splitSymbols(const uint16_t *sorted, uint8_t count, uint8_t jumpShift,
+                         uint16_t *symbolMaxUs, uint32_t *symbolSums, uint8_t *symbolCounts)
+    {
+        uint8_t symbolsCount = 0;
+        for (uint8_t idx = 0; idx < count; idx++)
+        {
+            if (idx == 0 || sorted[idx] - sorted[idx - 1] > (sorted[idx - 1] >> jumpShift))
+            {
+                if (symbolsCount == symbolsMax)
+                {
+                    return 0;
+                }
+                symbolSums[symbolsCount] = 0;
+                symbolCounts[symbolsCount] = 0;
+                symbolsCount++;
+            }
+
+            symbolSums[symbolsCount - 1] += sorted[idx];
+            symbolCounts[symbolsCount - 1]++;
+            symbolMaxUs[symbolsCount - 1] = sorted[idx];
+        }
+
+        return symbolsCount;
+    }
+
+    /**
+     * @brief Append pulse to the waveform
+     *
+     * @param waveform Waveform being unpacked
+     * @param symbol Pulse duration index
+     */
+    void addPulse(Transmitter::Waveform &waveform, uint8_t symbol)
+    {
+        uint8_t &pulses = waveform.pulses[waveform.pulsesCount / 2];
+        pulses = ((waveform.pulsesCount % 2) == 0) ? symbol : (pulses | (symbol << 4));
+        waveform.pulsesCount++;
+    }
+
+    /**
+     * @brief Walk the packed frame
+     *
+     * @param packed Packed frame
+     * @param pWaveform Waveform to unpack the frame to, nullptr to check the frame only
+     * @return Packed frame size, bytes, 0 if packed data is corrupted
+     */
+    uint8_t parse(const uint8_t *packed, Transmitter::Waveform *pWaveform)
+    {
+        uint8_t symbolsCount = packed[0] & 0x0F;
+        uint8_t pairsCount = (packed[0] >> 4) + 1;
+        uint8_t framePairsCount = packed[1];
+        if (symbolsCount == 0 || symbolsCount > symbolsMax ||
+            framePairsCount == 0 || framePairsCount > pulsesMax / 2)
+        {
+            return 0;
+        }
+
+        const uint8_t *pSymbols = &packed[headerSize];
+        const uint8_t *pPairs = pSymbols + symbolsCount * sizeof(uint16_t);
+        uint8_t tokensPos = headerSize + symbolsCount * sizeof(uint16_t) + pairsCount;
+        for (uint8_t pairIdx = 0; pairIdx < pairsCount; pairIdx++)
+        {
+            if ((pPairs[pairIdx] & 0x0F) >= symbolsCount || (pPairs[pairIdx] >> 4) >= symbolsCount)
+            {
+                return 0;
+            }
+        }
+
+        if (pWaveform != nullptr)
+        {
+            for (uint8_t symbol = 0; symbol < symbolsCount; symbol++)
+            {
+                pWaveform->durationsUs[symbol] = pSymbols[symbol * 2] | (pSymbols[symbol * 2 + 1] << 8);
+            }
+            pWaveform->pulsesCount = 0;
+            pWaveform->isInverted = false;
+        }
+
+        BitStream stream = {(uint8_t *)&packed[tokensPos], 0, (uint16_t)((packedSizeMax - tokensPos) * 8), false};
+        const uint8_t indexBits = getIndexBits(pairsCount);
+        uint8_t decodedCount = 0;
+        while (decodedCount < framePairsCount)
+        {
+            uint8_t pairIdx = readBits(stream, indexBits);
+            uint8_t runLength = (readBits(stream, 1) != 0) ? readBits(stream, runBits) + 2 : 1;
+            if (stream.isOverflow == true || pairIdx >= pairsCount ||
+                decodedCount + runLength > framePairsCount)
+            {
+                return 0;
+            }
+
+            if (pWaveform != nullptr)
+            {
+                for (uint8_t idx = 0; idx < runLength; idx++)
+                {
+                    addPulse(*pWaveform, pPairs[pairIdx] & 0x0F);
+                    addPulse(*pWaveform, pPairs[pairIdx] >> 4);
+                }
+            }
+            decodedCount += runLength;
+        }
+
+        return tokensPos + (stream.bitPos + 7) / 8;
+    }
+} // namespace
+
+/**
+ * @brief Quantize and pack the frame
+ *
+ * @param pulses Pulse durations, microseconds (even number, the first pulse is high)
+ * @param pulsesCount Number of pulses
+ * @param packed Buffer for the packed frame (packedSizeMax bytes)
+ * @return Packed frame size, bytes, 0 if frame doesn't fit
+ */
+uint8_t RawFrame::encode(const uint16_t *pulses, uint8_t pulsesCount, uint8_t *packed)
+{
+    if (pulsesCount == 0 || (pulsesCount % 2) != 0 || pulsesCount > pulsesMax)
+    {
+        return 0;
+    }
+
+    // Quantize pulse durations into symbols
+    uint16_t sorted[pulsesMax];
+    for (uint8_t idx = 0; idx < pulsesCount; idx++)
+    {
+        uint8_t pos = idx;
+        for (; pos > 0 && sorted[pos - 1] > pulses[idx]; pos--)
+        {
+            sorted[pos] = sorted[pos - 1];
+        }
+        sorted[pos] = pulses[idx];
+    }
+
+    uint16_t symbolMaxUs[symbolsMax];
+    uint32_t symbolSums[symbolsMax];
+    uint8_t symbolCounts[symbolsMax];
+    uint8_t symbolsCount = 0;
+    for (int8_t jumpShift = jumpShiftMax; jumpShift >= 0 && symbolsCount == 0; jumpShift--)
+    {
+        symbolsCount = splitSymbols(sorted, pulsesCount, jumpShift, symbolMaxUs, symbolSums, symbolCounts);
+    }
+    if (symbolsCount == 0)
+    {
+        return 0;
+    }
+
+    uint8_t pulseSymbols[pulsesMax];
+    for (uint8_t pulseIdx = 0; pulseIdx < pulsesCount; pulseIdx++)
+    {
+        uint8_t symbol = 0;
+        while (pulses[pulseIdx] > symbolMaxUs[symbol])
+        {
+            symbol++;
+        }
+        pulseSymbols[pulseIdx] = symbol;
+    }
+
+    // Index distinct pulse pairs, pair indexes replace the symbols in place
+    uint8_t pairs[pairsMax];
+    uint8_t pairsCount = 0;
+    const uint8_t framePairsCount = pulsesCount / 2;
+    uint8_t *framePairs = pulseSymbols;
+    for (uint8_t framePairIdx = 0; framePairIdx < framePairsCount; framePairIdx++)
+    {
+        uint8_t pair = pulseSymbols[framePairIdx * 2] | (pulseSymbols[framePairIdx * 2 + 1] << 4);
+        uint8_t pairIdx = 0;
+        while (pairIdx < pairsCount && pairs[pairIdx] != pair)
+        {
+            pairIdx++;
+        }
+        if (pairIdx == pairsCount)
+        {
+            if (pairsCount == pairsMax)
+            {
+                return 0;
+            }
+            pairs[pairsCount++] = pair;
+        }
+        framePairs[framePairIdx] = pairIdx;
+    }
+
+    // Header and tables
+    uint8_t pos = 0;
+    packed[pos++] = symbolsCount | ((pairsCount - 1) << 4);
+    packed[pos++] = framePairsCount;
+    for (uint8_t symbol = 0; symbol < symbolsCount; symbol++)
+    {
+        uint16_t durationUs = (symbolSums[symbol] + symbolCounts[symbol] / 2) / symbolCounts[symbol];
+        packed[pos++] = durationUs & 0xFF;
+        packed[pos++] = durationUs >> 8;
+    }
+    for (uint8_t pairIdx = 0; pairIdx < pairsCount; pairIdx++)
+    {
+        packed[pos++] = pairs[pairIdx];
+    }
+
+    // Pair indexes with run lengths
+    BitStream stream = {&packed[pos], 0, (uint16_t)((packedSizeMax - pos) * 8), false};
+    const uint8_t indexBits = getIndexBits(pairsCount);
+    for (uint8_t framePairIdx = 0; framePairIdx < framePairsCount;)
+    {
+        uint8_t runLength = 1;
+        while (framePairIdx + runLength < framePairsCount && runLength < runMax &&
+               framePairs[framePairIdx + runLength] == framePairs[framePairIdx])
+        {
+            runLength++;
+        }
+
+        writeBits(stream, framePairs[framePairIdx], indexBits);
+        writeBits(stream, (runLength > 1) ? 1 : 0, 1);
+        if (runLength > 1)
+        {
+            writeBits(stream, runLength - 2, runBits);
+        }
+        framePairIdx += runLength;
+    }
+
+    if (stream.isOverflow == true)
+    {
+        return 0;
+    }
+
+    return pos + (stream.bitPos + 7) / 8;
+}
+
+/**
+ * @brief Unpack frame to the waveform for sending
+ *
+ * @param packed Packed frame
+ * @param waveform Object to store the waveform
+ * @return true if frame is unpacked, false if packed data is corrupted
+ */
+bool RawFrame::decode(const uint8_t *packed, Transmitter::Waveform &waveform)
+{
+    return parse(packed, &waveform) != 0;
+}
+
+/**
+ * @brief Return packed frame size
+ *
+ * @param packed Packed frame
+ * @return Packed frame size, bytes, 0 if packed data is corrupted
+ */
+uint8_t RawFrame::getPackedSize(const uint8_t *packed)
+{
+    return parse(packed, nullptr);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "transmitter.h"
+
+/**
+ * Packed raw frame, for captures that no known protocol decodes
+ *
+ * Pulse durations are quantized into a per-frame table of timing symbols, pulse pairs are
+ * indexed in a table of the distinct (high, low) symbol pairs and the frame is stored as a bit
+ * stream of pair indexes with run lengths:
+ * - byte 0: symbols count (bits 0-3), pairs count - 1 (bits 4-7)
+ * - byte 1: number of pulse pairs in the frame
+ * - symbol durations, 2 bytes each (little endian, microseconds)
+ * - pairs, 1 byte each: high symbol (bits 0-3), low symbol (bits 4-7)
+ * - tokens, LSB first: pair index (as many bits as the pairs count needs), run flag (1 bit),
+ *   if flag is set: run length - 2 (runBits bits)
+ */
+namespace RawFrame
+{
+    // Maximum number of distinct pulse durations
+    static constexpr uint8_t symbolsMax = 8;
+    // Maximum number of distinct pulse pairs
+    static constexpr uint8_t pairsMax = 16;
+    // Maximum number of pulses, frame starts with the high level and ends with the low one
+    static constexpr uint8_t pulsesMax = Transmitter::pulsesMax;
+    // Maximum packed frame size, bytes
+    static constexpr uint8_t packedSizeMax = 44;
+    // Bits of the run length
+    static constexpr uint8_t runBits = 3;
+
+    static_assert(symbolsMax <= Transmitter::durationsCount);
+
+    /**
+     * @brief Quantize and pack the frame
+     *
+     * @param pulses Pulse durations, microseconds (even number, the first pulse is high)
+     * @param pulsesCount Number of pulses
+     * @param packed Buffer for the packed frame (packedSizeMax bytes)
+     * @return Packed frame size, bytes, 0 if frame doesn't fit
+     */
+    uint8_t encode(const uint16_t *pulses, uint8_t pulsesCount, uint8_t *packed);
+
+    /**
+     * @brief Unpack frame to the waveform for sending
+     *
+     * @param packed Packed frame
+     * @param waveform Object to store the waveform
+     * @return true if frame is unpacked, false if packed data is corrupted
+     */
+    bool decode(const uint8_t *packed, Transmitter::Waveform &waveform);
+
+    /**
+     * @brief Return packed frame size
+     *
+     * @param packed Packed frame
+     * @return Packed frame size, bytes, 0 if packed data is corrupted
+     */
+    uint8_t getPackedSize(const uint8_t *packed);
+} // namespace RawFrame
@@ -0,0 +1,245 @@
+#include "receiver.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hal.h"
+
+using namespace Receiver;
+
+namespace
+{
+    // Level longer than this is a gap between frames, microseconds
+    constexpr uint16_t separationLimitUs = 4300;
+    // Gaps of the repeated frames differ less than this, microseconds
+    constexpr uint16_t gapToleranceUs = 200;
+    // Allowed pulse deviation, percent of the pulse length
+    constexpr uint8_t tolerancePercent = 60;
+    // Level durations of a frame: gap, 32 data bits and sync
+    constexpr uint8_t durationsMax = 67;
+    // Frames with fewer level durations are noise, no device sends them
+    constexpr uint8_t durationsMin = 8;
+
+    // Level durations since the gap starting the frame, the gap is the first one
+    uint16_t durations[durationsMax];
+    uint8_t durationsCount = 0;
+    unsigned long lastEdgeTimeUs = 0;
+    uint8_t receiverInterrupt = 0;
+
+    volatile uint16_t protocolMask = protocolMaskAll;
+    ProtocolStats stats[Protocol::count];
+
+    Slot::Signal receivedSignal;
+    volatile bool isAvailable = false;
+
+    /**
+     * @brief Return absolute difference of two durations
+     */
+    inline uint16_t diff(uint16_t a, uint16_t b)
+    {
+        return (a > b) ? (a - b) : (b - a);
+    }
+
+    /**
+     * @brief Check if the level duration matches the pulse
+     *
+     * @param durationUs Level duration, microseconds
+     * @param delayUs Pulse length, microseconds
+     * @param factor Pulse length factor
+     * @param toleranceUs Allowed deviation, microseconds
+     * @return true if duration matches, false otherwise
+     */
+    inline bool isPulse(uint16_t durationUs, uint16_t delayUs, uint8_t factor, uint16_t toleranceUs)
+    {
+        uint32_t pulseUs = (uint32_t)delayUs * factor;
+        uint32_t deltaUs = (durationUs > pulseUs) ? (durationUs - pulseUs) : (pulseUs - durationUs);
+        return deltaUs < toleranceUs;
+    }
+
+    /**
+     * @brief Decode recorded frame with the protocol
+     *
+     * @param protocol Protocol number
+     * @param signal Object to store the decoded signal
+     * @return true if frame matches the protocol, false otherwise
+     */
+    bool decode(uint8_t protocol, Slot::Signal &signal)
+    {
+        Protocol::Timing timing;
+        Protocol::getTiming(protocol, timing);
+
+        // Gap is the longer level of the sync, it gives the pulse length
+        uint8_t syncFactor = (timing.sync.low > timing.sync.high) ? timing.sync.low : timing.sync.high;
+        uint16_t delayUs = durations[0] / syncFactor;
+        uint16_t toleranceUs = (uint32_t)delayUs * tolerancePercent / 100;
+        // Gap of the inverted protocols is followed by the short sync level
+        uint8_t firstDataIdx = (timing.isInverted == true) ? 2 : 1;
+
+        uint32_t value = 0;
+        for (uint8_t idx = firstDataIdx; idx + 1 < durationsCount; idx += 2)
+        {
+            value <<= 1;
+            if (isPulse(durations[idx], delayUs, timing.zero.high, toleranceUs) == true &&
+                isPulse(durations[idx + 1], delayUs, timing.zero.low, toleranceUs) == true)
+            {
+                // Zero bit
+            }
+            else if (isPulse(durations[idx], delayUs, timing.one.high, toleranceUs) == true &&
+                     isPulse(durations[idx + 1], delayUs, timing.one.low, toleranceUs) == true)
+            {
+                value |= 1;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        signal = {value, protocol, (uint8_t)((durationsCount - 1) / 2), delayUs};
+        return true;
+    }
+
+    /**
+     * @brief Try enabled protocols on the recorded frame, the first match wins
+     */
+    void decodeFrame()
+    {
+        uint16_t mask = protocolMask;
+        for (uint8_t protocol = 1; protocol <= Protocol::count; protocol++)
+        {
+            if ((mask & (1U << (protocol - 1))) == 0)
+            {
+                continue;
+            }
+
+            ProtocolStats &protocolStats = stats[protocol - 1];
+            if (protocolStats.attempts < UINT16_MAX)
+            {
+                protocolStats.attempts++;
+            }
+            if (decode(protocol, receivedSignal) == true)
+            {
+                if (protocolStats.decodes < UINT16_MAX)
+                {
+                    protocolStats.decodes++;
+                }
+                isAvailable = true;
+                break;
+            }
+        }
+    }
+
+    /**
+     * @brief External interrupt handler, records level duration and decodes complete frames
+     */
+    void onEdge()
+    {
+        unsigned long timeUs = Hal::Clock::micros();
+        unsigned long elapsedUs = timeUs - lastEdgeTimeUs;
+        lastEdgeTimeUs = timeUs;
+        uint16_t durationUs = (elapsedUs > UINT16_MAX) ? UINT16_MAX : elapsedUs;
+
+        if (durationUs > separationLimitUs)
+        {
+            // Gap similar to the one starting the recorded frame completes it,
+            // senders repeat frames with the same gaps between them
+            if (durationsCount >= durationsMin && diff(durationUs, durations[0]) < gapToleranceUs)
+            {
+                decodeFrame();
+            }
+            // The gap starts the next frame
+            durationsCount = 0;
+        }
+        else if (durationsCount == 0 || durationsCount == durationsMax)
+        {
+            // Frame doesn't start with a gap or it is too long
+            durationsCount = 0;
+            return;
+        }
+
+        durations[durationsCount++] = durationUs;
+    }
+} // namespace
+
+/**
+ * @brief Start receiver, signal received before is dropped
+ *
+ * @param interrupt External interrupt number
+ */
+void Receiver::start(uint8_t interrupt)
+{
+    receiverInterrupt = interrupt;
+    durationsCount = 0;
+    isAvailable = false;
+    lastEdgeTimeUs = Hal::Clock::micros();
+    Hal::Gpio::attachInterrupt(receiverInterrupt, onEdge);
+}
+
+/**
+ * @brief Stop receiver
+ */
+void Receiver::stop()
+{
+    Hal::Gpio::detachInterrupt(receiverInterrupt);
+}
+
+/**
+ * @brief Read the last received signal
+ * Signal is returned once, frames received before the call are dropped
+ *
+ * @param signal Object to copy the signal
+ * @return true if new signal is received, false otherwise
+ */
+bool Receiver::read(Slot::Signal &signal)
+{
+    uint8_t state = Hal::Interrupts::lock();
+    bool result = isAvailable;
+    if (result == true)
+    {
+        signal = receivedSignal;
+        isAvailable = false;
+    }
+    Hal::Interrupts::restore(state);
+
+    return result;
+}
+
+/**
+ * @brief Set protocols tried on the received frames
+ *
+ * @param mask Protocol mask, bit 0 is protocol 1
+ */
+void Receiver::setProtocolMask(uint16_t mask)
+{
+    protocolMask = mask & protocolMaskAll;
+}
+
+/**
+ * @brief Return protocols tried on the received frames
+ *
+ * @return Protocol mask, bit 0 is protocol 1
+ */
+uint16_t Receiver::getProtocolMask()
+{
+    return protocolMask;
+}
+
+/**
+ * @brief Return decoding counters of the protocol since startup
+ * Counters stop at their maximum
+ *
+ * @param protocol Protocol number
+ * @param stats Object to copy the counters
+ */
+void Receiver::getStats(uint8_t protocol, ProtocolStats &stats)
+{
+    if (protocol == 0 || protocol > Protocol::count)
+    {
+        stats = {};
+        return;
+    }
+
+    uint8_t state = Hal::Interrupts::lock();
+    stats = ::stats[protocol - 1];
+    Hal::Interrupts::restore(state);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "protocol.h"
+#include "slot.h"
+
+/**
+ * Radio signal receiver
+ *
+ * Frames are decoded from the RX pin edges in the external interrupt, the same way as the
+ * rc-switch library does: level durations between two similar gaps are matched against the
+ * pulse pairs of every protocol. Only the protocols of the mask are tried, so the interrupt
+ * takes less time with fewer protocols enabled.
+ * Receiver owns the external interrupt, Capture should be stopped while it runs.
+ */
+namespace Receiver
+{
+    // Mask of all protocols, bit 0 is protocol 1
+    static constexpr uint16_t protocolMaskAll = (1U << Protocol::count) - 1;
+
+    /**
+     * @brief Decoding counters of a protocol
+     */
+    struct ProtocolStats
+    {
+        // Frames tried against the protocol
+        uint16_t attempts;
+        // Frames decoded by the protocol
+        uint16_t decodes;
+    };
+
+    /**
+     * @brief Start receiver, signal received before is dropped
+     *
+     * @param interrupt External interrupt number
+     */
+    void start(uint8_t interrupt);
+
+    /**
+     * @brief Stop receiver
+     */
+    void stop();
+
+    /**
+     * @brief Read the last received signal
+     * Signal is returned once, frames received before the call are dropped
+     *
+     * @param signal Object to copy the signal
+     * @return true if new signal is received, false otherwise
+     */
+    bool read(Slot::Signal &signal);
+
+    /**
+     * @brief Set protocols tried on the received frames
+     *
+     * @param mask Protocol mask, bit 0 is protocol 1
+     */
+    void setProtocolMask(uint16_t mask);
+
+    /**
+     * @brief Return protocols tried on the received frames
+     *
+     * @return Protocol mask, bit 0 is protocol 1
+     */
+    uint16_t getProtocolMask();
+
+    /**
+     * @brief Return decoding counters of the protocol since startup
+     * Counters stop at their maximum
+     *
+     * @param protocol Protocol number
+     * @param stats Object to copy the counters
+     */
+    void getStats(uint8_t protocol, ProtocolStats &stats);
+} // namespace Receiver
@@ -0,0 +1,201 @@
+// RX to TX loopback benchmark
+//
+// Remotes of every protocol send frames with their pulse length off the nominal one. Frames are
+// decoded by the receiver interrupt with only the remote protocol enabled (several protocols
+// have the same pulse ratios), the signal is saved to a slot and sent back by the transmitter.
+// TX edges are checked by a receiver model tuned to the remote: the first frame is accepted if
+// every level is within its tolerance of the remote timing. Reports first-frame acceptance of
+// the signal sent with the protocol pulse length and with the measured one. Protocol 4 sync is
+// shorter than the gap between frames the receiver looks for, so it is never decoded.
+
+#include "hal.h"
+#include "protocol.h"
+#include "receiver.h"
+#include "sim.h"
+#include "slot.h"
+#include "transmitter.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+namespace
+{
+    constexpr uint8_t rxInterrupt = 0;
+    constexpr uint8_t bitLength = 24;
+    constexpr uint8_t rxFramesCount = 6;
+    // Remote pulse length deviations from the nominal one, percent
+    constexpr int deviationsPercent[] = {-30, -25, -20, -15, -10, -5, 0, 5, 10, 15, 20, 25, 30};
+    constexpr uint8_t deviationsCount = sizeof(deviationsPercent) / sizeof(*deviationsPercent);
+    // Level tolerance of the receiver model, percent of the remote level duration
+    constexpr unsigned tolerancePercent = 20;
+    // Longest frame: 32 data bits and sync of the slowest protocol at the longest pulse
+    constexpr unsigned long frameTimeMaxUs = 500000;
+
+    uint32_t seed = 1;
+
+    // Edges sent by the transmitter
+    constexpr uint8_t txEdgesMax = Transmitter::pulsesMax * 2 + 2;
+    unsigned long long txEdgeTimesUs[txEdgesMax];
+    uint8_t txEdgesCount = 0;
+
+    uint32_t random()
+    {
+        // Numerical Recipes LCG, deterministic between runs
+        seed = seed * 1664525UL + 1013904223UL;
+        return seed;
+    }
+
+    void onTxEdge(uint8_t level, unsigned long long timeUs)
+    {
+        if (txEdgesCount < txEdgesMax)
+        {
+            txEdgeTimesUs[txEdgesCount++] = timeUs;
+        }
+    }
+
+    uint16_t getPulseDuration(const Transmitter::Waveform &waveform, uint8_t pulseIdx)
+    {
+        uint8_t pulses = waveform.pulses[pulseIdx / 2];
+        return waveform.durationsUs[((pulseIdx % 2) == 0) ? (pulses & 0x0F) : (pulses >> 4)];
+    }
+
+    /**
+     * @brief Receive the remote frames
+     *
+     * @param protocol Protocol number
+     * @param value Signal value
+     * @param pulseLengthUs Pulse length of the remote, microseconds
+     * @param signal Object to store the decoded signal
+     * @return true if signal is decoded, false otherwise
+     */
+    bool receive(uint8_t protocol, uint32_t value, uint16_t pulseLengthUs, Slot::Signal &signal)
+    {
+        Receiver::start(rxInterrupt);
+        Sim::receiveSignal(protocol, value, bitLength, rxFramesCount, pulseLengthUs);
+        Sim::advance(rxFramesCount * frameTimeMaxUs);
+        bool isDecoded = Receiver::read(signal);
+        Receiver::stop();
+
+        return (isDecoded == true && signal.protocol == protocol && signal.value == value);
+    }
+
+    /**
+     * @brief Save signal to the slot and load it back, as Emulate does
+     *
+     * @param signal Signal to store, replaced by the loaded one
+     */
+    void store(Slot::Signal &signal)
+    {
+        Slot::begin(0);
+        Slot::modifySignal(signal);
+        Slot::commit();
+        while (Slot::isPending() == true)
+        {
+            Sim::advance(1000);
+        }
+        Slot::getSignal(0, signal);
+    }
+
+    /**
+     * @brief Send the signal and check its first frame with the receiver model
+     *
+     * @param signal Signal to send
+     * @param remote Waveform of the remote
+     * @return true if the first frame is accepted, false otherwise
+     */
+    bool isFirstFrameAccepted(const Slot::Signal &signal, const Transmitter::Waveform &remote)
+    {
+        txEdgesCount = 0;
+        // The second frame ends the last level of the first one
+        Transmitter::enqueue(signal, 2, 0);
+        while (Transmitter::isBusy() == true)
+        {
+            Sim::advance(1000);
+        }
+
+        // Transmitter idles low, the first level of the inverted protocols merges with it
+        uint8_t firstPulseIdx = (remote.isInverted == true) ? 1 : 0;
+        if (txEdgesCount < remote.pulsesCount - firstPulseIdx + 1)
+        {
+            return false;
+        }
+
+        for (uint8_t pulseIdx = firstPulseIdx; pulseIdx < remote.pulsesCount; pulseIdx++)
+        {
+            uint8_t edgeIdx = pulseIdx - firstPulseIdx;
+            long durationUs = txEdgeTimesUs[edgeIdx + 1] - txEdgeTimesUs[edgeIdx];
+            long expectedUs = getPulseDuration(remote, pulseIdx);
+            long errorUs = (durationUs > expectedUs) ? (durationUs - expectedUs) : (expectedUs - durationUs);
+            if (errorUs * 100 > expectedUs * (long)tolerancePercent)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+} // namespace
+
+int main()
+{
+    Slot::initialize();
+    Transmitter::initialize(Hal::Timer::outputPin);
+    Sim::setTxEdgeHandler(onTxEdge);
+
+    printf("protocol  decoded  nominal  measured  pulse error\n");
+
+    unsigned totalDecoded = 0;
+    unsigned totalNominal = 0;
+    unsigned totalMeasured = 0;
+
+    for (uint8_t protocol = 1; protocol <= Protocol::count; protocol++)
+    {
+        Protocol::Timing timing;
+        Protocol::getTiming(protocol, timing);
+        Receiver::setProtocolMask(1U << (protocol - 1));
+
+        unsigned decoded = 0;
+        unsigned nominalAccepted = 0;
+        unsigned measuredAccepted = 0;
+        double errorMax = 0;
+
+        for (int deviationPercent : deviationsPercent)
+        {
+            uint32_t value = random() & ((1UL << bitLength) - 1);
+            uint16_t remotePulseUs = timing.pulseLength * (100 + deviationPercent) / 100;
+
+            Slot::Signal signal;
+            if (receive(protocol, value, remotePulseUs, signal) == false)
+            {
+                continue;
+            }
+            decoded++;
+            store(signal);
+
+            double error = (double)signal.pulseLengthUs / remotePulseUs - 1.0;
+            error = (error < 0) ? -error : error;
+            errorMax = (error > errorMax) ? error : errorMax;
+
+            Transmitter::Waveform remote;
+            Transmitter::encode({value, protocol, bitLength, remotePulseUs}, remote);
+
+            Slot::Signal nominal = signal;
+            nominal.pulseLengthUs = 0;
+            nominalAccepted += isFirstFrameAccepted(nominal, remote) ? 1 : 0;
+            measuredAccepted += isFirstFrameAccepted(signal, remote) ? 1 : 0;
+        }
+
+        printf("%8u  %4u/%-2u  %6u%%  %7u%%  %9.1f%%\n", protocol, decoded, deviationsCount,
+               decoded ? nominalAccepted * 100 / decoded : 0, decoded ? measuredAccepted * 100 / decoded : 0,
+               errorMax * 100);
+
+        totalDecoded += decoded;
+        totalNominal += nominalAccepted;
+        totalMeasured += measuredAccepted;
+    }
+
+    printf("total: %u signals, first frame accepted with nominal pulse %u%%, with measured pulse %u%%\n",
+           totalDecoded, totalNominal * 100 / totalDecoded, totalMeasured * 100 / totalDecoded);
+
+    return (totalMeasured == totalDecoded) ? 0 : 1;
+}
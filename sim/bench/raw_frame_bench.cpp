@@ -0,0 +1,138 @@
+// Raw frame packing benchmark
+//
+// Frames of every protocol are captured with timing jitter, packed, unpacked and compared
+// with the original pulses. Reports packed size, compression ratio against 16-bit pulse
+// durations, worst timing error and host time per frame.
+
+#include "protocol.h"
+#include "raw_frame.h"
+#include "transmitter.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+
+namespace
+{
+    constexpr unsigned framesPerLength = 200;
+    constexpr uint8_t bitLengths[] = {12, 24, 32};
+    // Capture jitter, percent of the pulse duration
+    constexpr unsigned jitterPercent = 10;
+
+    uint32_t seed = 1;
+
+    uint32_t random()
+    {
+        // Numerical Recipes LCG, deterministic between runs
+        seed = seed * 1664525UL + 1013904223UL;
+        return seed;
+    }
+
+    uint16_t getPulseDuration(const Transmitter::Waveform &waveform, uint8_t pulseIdx)
+    {
+        uint8_t pulses = waveform.pulses[pulseIdx / 2];
+        return waveform.durationsUs[((pulseIdx % 2) == 0) ? (pulses & 0x0F) : (pulses >> 4)];
+    }
+
+    double getTimeNs()
+    {
+        using namespace std::chrono;
+        return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+    }
+} // namespace
+
+int main()
+{
+    printf("protocol bits  frames failed  packed  ratio  error  encode   decode\n");
+
+    unsigned totalFrames = 0;
+    unsigned totalFailed = 0;
+    unsigned long totalRawBytes = 0;
+    unsigned long totalPackedBytes = 0;
+
+    for (uint8_t protocol = 1; protocol <= Protocol::count; protocol++)
+    {
+        for (uint8_t bitLength : bitLengths)
+        {
+            unsigned failed = 0;
+            unsigned long rawBytes = 0;
+            unsigned long packedBytes = 0;
+            double errorMax = 0;
+            double encodeNs = 0;
+            double decodeNs = 0;
+
+            for (unsigned frame = 0; frame < framesPerLength; frame++)
+            {
+                uint32_t value = random() & ((bitLength < 32) ? ((1UL << bitLength) - 1) : 0xFFFFFFFFUL);
+                Transmitter::Waveform waveform;
+                Transmitter::encode({value, protocol, bitLength}, waveform);
+
+                // Captured pulses, inverted protocols start from the low level which is dropped
+                uint16_t pulses[RawFrame::pulsesMax];
+                uint16_t cleanPulses[RawFrame::pulsesMax];
+                uint8_t pulsesCount = 0;
+                uint8_t firstPulseIdx = waveform.isInverted ? 1 : 0;
+                for (uint8_t pulseIdx = firstPulseIdx; pulseIdx < waveform.pulsesCount; pulseIdx++)
+                {
+                    uint16_t durationUs = getPulseDuration(waveform, pulseIdx);
+                    int jitterUs = (int)(random() % (2 * jitterPercent + 1)) - (int)jitterPercent;
+                    cleanPulses[pulsesCount] = durationUs;
+                    pulses[pulsesCount++] = durationUs + durationUs * jitterUs / 100;
+                }
+                if ((pulsesCount % 2) != 0)
+                {
+                    // Frame ends with the low level, it is merged with the gap before the next frame
+                    cleanPulses[pulsesCount] = getPulseDuration(waveform, 0);
+                    pulses[pulsesCount] = cleanPulses[pulsesCount];
+                    pulsesCount++;
+                }
+
+                uint8_t packed[RawFrame::packedSizeMax];
+                double startNs = getTimeNs();
+                uint8_t packedSize = RawFrame::encode(pulses, pulsesCount, packed);
+                encodeNs += getTimeNs() - startNs;
+
+                Transmitter::Waveform decoded;
+                startNs = getTimeNs();
+                bool isDecoded = (packedSize > 0 && RawFrame::decode(packed, decoded) == true);
+                decodeNs += getTimeNs() - startNs;
+
+                if (isDecoded == false || decoded.pulsesCount != pulsesCount ||
+                    RawFrame::getPackedSize(packed) != packedSize)
+                {
+                    failed++;
+                    continue;
+                }
+
+                for (uint8_t pulseIdx = 0; pulseIdx < pulsesCount; pulseIdx++)
+                {
+                    double error = (double)getPulseDuration(decoded, pulseIdx) / cleanPulses[pulseIdx] - 1.0;
+                    error = (error < 0) ? -error : error;
+                    errorMax = (error > errorMax) ? error : errorMax;
+                }
+                rawBytes += pulsesCount * sizeof(uint16_t);
+                packedBytes += packedSize;
+            }
+
+            unsigned packedFrames = framesPerLength - failed;
+            printf("%8u %4u  %6u %6u  %6.1f  %5.1f  %4.0f%%  %5.0fns  %5.0fns\n",
+                   protocol, bitLength, framesPerLength, failed,
+                   packedFrames ? (double)packedBytes / packedFrames : 0.0,
+                   packedBytes ? (double)rawBytes / packedBytes : 0.0,
+                   errorMax * 100, encodeNs / framesPerLength, decodeNs / framesPerLength);
+
+            totalFrames += framesPerLength;
+            totalFailed += failed;
+            totalRawBytes += rawBytes;
+            totalPackedBytes += packedBytes;
+        }
+    }
+
+    printf("total: %u frames, %u failed, %.1f bytes per frame, ratio %.1f\n",
+           totalFrames, totalFailed,
+           (double)totalPackedBytes / (totalFrames - totalFailed), (double)totalRawBytes / totalPackedBytes);
+
+    return (totalFailed == 0) ? 0 : 1;
+}
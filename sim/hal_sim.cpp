@@ -0,0 +1,858 @@
+#include "hal.h"
+#include "sim.h"
+#include "protocol.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+using namespace Hal;
+
+namespace
+{
+    // Modeled hardware costs, microseconds
+    constexpr unsigned long i2cBytesPerMs = 44;        // 400 kHz I2C, 9 clocks per byte
+    constexpr unsigned long i2cByteCpuTimeUs = 3;      // Queueing a byte and the TWI interrupt sending it
+    constexpr unsigned long i2cPageSetupBytes = 8;     // Addressing commands per page transfer
+    constexpr unsigned long eepromWriteTimeUs = 3300;  // ATmega328P EEPROM byte write
+    constexpr unsigned long analogReadTimeUs = 112;    // ADC conversion at default prescaler
+    constexpr unsigned long eepromPollTimeUs = 1;      // EEPROM ready polling iteration
+    constexpr unsigned long eepromReadTimeUs = 1;      // EEPROM byte read with call overhead
+    constexpr unsigned long timerWrapTimeUs = 32768;   // Timer1 period at clk/8 prescaler
+    constexpr unsigned long interruptLatencyUs = 3;    // Interrupt entry until the handler writes a pin
+    constexpr unsigned long interruptTimeUs = 8;       // CPU time taken by one interrupt handler
+    constexpr unsigned long millisPeriodUs = 1024;     // Timer0 overflow interrupt keeping millis()
+    constexpr unsigned long millisInterruptTimeUs = 5;
+
+    constexpr uint8_t pinsCount = 20;
+    // External interrupt pins of ATmega328P
+    constexpr uint8_t interruptPins[] = {2, 3};
+    constexpr uint8_t interruptsCount = sizeof(interruptPins) / sizeof(*interruptPins);
+    static_assert(Sim::eepromSize == Eeprom::size);
+
+    unsigned long long timeUs = 0;
+    Sim::Stats stats = {};
+
+    uint8_t pinLevels[pinsCount];
+    uint16_t analogValues[pinsCount];
+    bool isPinsInitialized = false;
+
+    uint8_t eeprom[Sim::eepromSize];
+    bool isEepromInitialized = false;
+    // Completion time of the EEPROM write in progress
+    unsigned long long eepromBusyUntilUs = 0;
+    void (*eepromReadyHandler)() = nullptr;
+    bool isEepromReadyInterruptEnabled = false;
+
+    void (*edgeHandlers[interruptsCount])() = {nullptr};
+
+    /**
+     * @brief Source of the scripted RX pin edges
+     */
+    enum class RxSource
+    {
+        None,
+        Noise,
+        Pulses,
+    };
+
+    constexpr uint8_t rxPin = 2;
+    RxSource rxSource = RxSource::None;
+    unsigned long long rxNextEdgeUs = 0;
+    // Random edges
+    unsigned long long noiseEndUs = 0;
+    unsigned long noiseIntervalUs = 0;
+    uint32_t noiseSeed = 1;
+    // Repeated pulse train
+    uint16_t rxPulses[Sim::rxPulsesMax];
+    uint8_t rxPulsesCount = 0;
+    uint8_t rxPulseIdx = 0;
+    uint16_t rxRepeatsLeft = 0;
+
+    // Time of the next timer event
+    unsigned long long timerDueUs = 0;
+    void (*timerHandler)() = nullptr;
+    bool isTimerEnabled = false;
+
+    bool isInterruptsEnabled = true;
+    bool isDispatching = false;
+    // Time of the interrupt being dispatched
+    unsigned long long eventTimeUs = 0;
+    // Time the handler of the dispatched interrupt starts, later than its event if CPU is busy
+    unsigned long long handlerStartUs = 0;
+    // Time the CPU is free of interrupt handlers or critical sections
+    unsigned long long interruptsFreeUs = 0;
+
+    uint8_t framebuffer[Sim::screenPages][Sim::screenWidth];
+    // Printed characters at glyph start columns, for text dump
+    char textCells[Sim::screenPages][Sim::screenWidth];
+    uint8_t textWidths[Sim::screenPages][Sim::screenWidth];
+    bool textInverted[Sim::screenPages][Sim::screenWidth];
+    Screen::Font screenFont = Screen::Font::Font_6x8;
+    bool isScreenInverted = false;
+    // Time the last queued screen byte is sent
+    unsigned long long screenIdleUs = 0;
+
+    uint8_t txPin = 0;
+    uint8_t txLevel = Gpio::levelLow;
+    // Level set by the timer hardware on the next event, if output pin is connected
+    uint8_t timerOutputLevel = Gpio::levelLow;
+    bool isTimerOutputConnected = false;
+    void (*txEdgeHandler)(uint8_t level, unsigned long long timeUs) = nullptr;
+
+    /**
+     * @brief Reported time measurement
+     */
+    struct Measurement
+    {
+        const char *name;
+        unsigned long timeUs;
+    };
+
+    constexpr uint8_t measurementsMax = 16;
+    Measurement measurements[measurementsMax];
+    uint8_t measurementsCount = 0;
+
+    /**
+     * @brief Queue bytes of the screen transfers, caller waits while the queue is full
+     * Framebuffer is updated at once, only the transfer time is modeled
+     *
+     * @param bytes Number of bytes
+     */
+    void queueScreenBytes(unsigned long bytes)
+    {
+        stats.i2cBytes += bytes;
+        timeUs += bytes * i2cByteCpuTimeUs;
+
+        unsigned long long startUs = (screenIdleUs > timeUs) ? screenIdleUs : timeUs;
+        screenIdleUs = startUs + bytes * 1000 / i2cBytesPerMs;
+        unsigned long long queueTimeUs = Screen::queueSize * 1000 / i2cBytesPerMs;
+        if (screenIdleUs > timeUs + queueTimeUs)
+        {
+            timeUs = screenIdleUs - queueTimeUs;
+        }
+    }
+
+    void initializePins()
+    {
+        if (isPinsInitialized == false)
+        {
+            // Inputs are pulled up when nothing is connected
+            memset(pinLevels, Gpio::levelHigh, sizeof(pinLevels));
+            // About 3.9V on the battery input
+            analogValues[Gpio::pinA0] = 800;
+            isPinsInitialized = true;
+        }
+    }
+
+    void initializeEeprom()
+    {
+        if (isEepromInitialized == false)
+        {
+            // Erased EEPROM cells read as 0xFF
+            memset(eeprom, 0xFF, sizeof(eeprom));
+            isEepromInitialized = true;
+        }
+    }
+
+    /**
+     * @brief Set pin level and call its external interrupt handler on change
+     *
+     * @param pin Pin number
+     * @param level New pin level
+     */
+    void changePinLevel(uint8_t pin, uint8_t level)
+    {
+        if (pinLevels[pin] == level)
+        {
+            return;
+        }
+
+        pinLevels[pin] = level;
+        for (uint8_t interrupt = 0; interrupt < interruptsCount; interrupt++)
+        {
+            if (interruptPins[interrupt] == pin && edgeHandlers[interrupt] != nullptr)
+            {
+                edgeHandlers[interrupt]();
+            }
+        }
+    }
+
+    /**
+     * @brief Return next noise interval, uniformly spread around the mean interval
+     */
+    unsigned long getNoiseInterval()
+    {
+        // Numerical Recipes LCG, deterministic between runs
+        noiseSeed = noiseSeed * 1664525UL + 1013904223UL;
+        return noiseIntervalUs / 2 + (noiseSeed >> 8) % (noiseIntervalUs + 1);
+    }
+
+    /**
+     * @brief Toggle RX pin and schedule its next edge
+     */
+    void generateRxEdge()
+    {
+        changePinLevel(rxPin, (pinLevels[rxPin] == Gpio::levelHigh) ? Gpio::levelLow : Gpio::levelHigh);
+
+        if (rxSource == RxSource::Noise)
+        {
+            rxNextEdgeUs += getNoiseInterval();
+            if (rxNextEdgeUs >= noiseEndUs)
+            {
+                rxSource = RxSource::None;
+            }
+        }
+        else if (rxSource == RxSource::Pulses)
+        {
+            rxNextEdgeUs += rxPulses[rxPulseIdx++];
+            if (rxPulseIdx == rxPulsesCount)
+            {
+                rxPulseIdx = 0;
+                if (--rxRepeatsLeft == 0)
+                {
+                    // Pin stays low after the last pulse
+                    rxSource = RxSource::None;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Set transmitter carrier level, count its edges
+     *
+     * @param level New carrier level
+     * @param edgeTimeUs Time the level changes
+     */
+    void setTxLevel(uint8_t level, unsigned long long edgeTimeUs)
+    {
+        if (level != txLevel)
+        {
+            txLevel = level;
+            stats.rfTxEdges++;
+            if (txEdgeHandler != nullptr)
+            {
+                txEdgeHandler(level, edgeTimeUs);
+            }
+        }
+    }
+
+    /**
+     * @brief Start handler of the interrupt event, handlers run one by one
+     *
+     * @param dueUs Time of the event
+     */
+    void beginHandler(unsigned long long dueUs)
+    {
+        eventTimeUs = dueUs;
+        handlerStartUs = (dueUs > interruptsFreeUs) ? dueUs : interruptsFreeUs;
+        // Handler waits for the millis() interrupt if it is running
+        unsigned long long millisStartUs = handlerStartUs - handlerStartUs % millisPeriodUs;
+        if (handlerStartUs < millisStartUs + millisInterruptTimeUs)
+        {
+            handlerStartUs = millisStartUs + millisInterruptTimeUs;
+        }
+        interruptsFreeUs = handlerStartUs + interruptTimeUs;
+    }
+
+    /**
+     * @brief Call handlers of the pending interrupts if interrupts are enabled
+     */
+    void dispatchInterrupts()
+    {
+        if (isInterruptsEnabled == false || isDispatching == true)
+        {
+            return;
+        }
+
+        isDispatching = true;
+        isInterruptsEnabled = false;
+
+        // Pending interrupts are handled in the order of their time
+        bool isEepromStalled = false;
+        while (true)
+        {
+            // EEPROM ready interrupt fires while EEPROM is ready and interrupt is enabled
+            bool isEepromDue = (isEepromStalled == false && isEepromReadyInterruptEnabled == true &&
+                                eepromReadyHandler != nullptr && eepromBusyUntilUs <= timeUs);
+            bool isTimerDue = (isTimerEnabled == true && timerHandler != nullptr && timerDueUs <= timeUs);
+            bool isRxEdgeDue = (rxSource != RxSource::None && rxNextEdgeUs <= timeUs);
+
+            if (isRxEdgeDue == true && (isTimerDue == false || rxNextEdgeUs <= timerDueUs) &&
+                (isEepromDue == false || rxNextEdgeUs <= eepromBusyUntilUs))
+            {
+                if (edgeHandlers[0] != nullptr)
+                {
+                    beginHandler(rxNextEdgeUs);
+                }
+                else
+                {
+                    // Nobody listens to the RX pin, CPU is not taken
+                    eventTimeUs = rxNextEdgeUs;
+                }
+                generateRxEdge();
+            }
+            else if (isTimerDue == true && (isEepromDue == false || timerDueUs <= eepromBusyUntilUs))
+            {
+                unsigned long long dueUs = timerDueUs;
+                beginHandler(dueUs);
+                if (isTimerOutputConnected == true && txPin == Timer::outputPin)
+                {
+                    // Compare match switches the pin before the handler runs
+                    setTxLevel(timerOutputLevel, dueUs);
+                }
+                timerHandler();
+                if (isTimerEnabled == true && timerDueUs == dueUs)
+                {
+                    // Handler didn't schedule the next event, compare matches again after the wrap
+                    timerDueUs += timerWrapTimeUs;
+                }
+            }
+            else if (isEepromDue == true)
+            {
+                unsigned long long busyUntilUs = eepromBusyUntilUs;
+                beginHandler(busyUntilUs);
+                eepromReadyHandler();
+                if (eepromBusyUntilUs == busyUntilUs && isEepromReadyInterruptEnabled == true)
+                {
+                    // Handler neither started a write nor disabled the interrupt, retry later
+                    isEepromStalled = true;
+                }
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        isInterruptsEnabled = true;
+        isDispatching = false;
+    }
+
+    void clearCells(uint8_t page, uint8_t xStart, uint8_t xEnd)
+    {
+        for (uint8_t x = 0; x < Sim::screenWidth; x++)
+        {
+            // Remove glyphs overlapping the range
+            if (textCells[page][x] != '\0' && x < xEnd && x + textWidths[page][x] > xStart)
+            {
+                textCells[page][x] = '\0';
+            }
+        }
+    }
+} // namespace
+
+void Sim::advance(unsigned long timeUs)
+{
+    ::timeUs += timeUs;
+    dispatchInterrupts();
+}
+
+unsigned long long Sim::getTime()
+{
+    return timeUs;
+}
+
+void Sim::setPinLevel(uint8_t pin, uint8_t level)
+{
+    initializePins();
+    if (pin < pinsCount)
+    {
+        bool isInterruptsEnabled = (Interrupts::lock() != 0);
+        beginHandler(timeUs);
+        isDispatching = true;
+        changePinLevel(pin, level);
+        isDispatching = false;
+        Interrupts::restore(isInterruptsEnabled ? 1 : 0);
+    }
+}
+
+void Sim::receiveNoise(unsigned long durationMs, unsigned long intervalUs)
+{
+    initializePins();
+    noiseIntervalUs = intervalUs;
+    noiseEndUs = timeUs + durationMs * 1000ULL;
+    rxNextEdgeUs = timeUs + getNoiseInterval();
+    rxSource = RxSource::Noise;
+}
+
+void Sim::receivePulses(const uint16_t *pulses, uint8_t pulsesCount, uint16_t repeatCount)
+{
+    initializePins();
+    if (pulsesCount == 0 || pulsesCount > rxPulsesMax || repeatCount == 0)
+    {
+        return;
+    }
+
+    memcpy(rxPulses, pulses, pulsesCount * sizeof(*pulses));
+    rxPulsesCount = pulsesCount;
+    rxPulseIdx = 0;
+    rxRepeatsLeft = repeatCount;
+    // The first edge is rising
+    pinLevels[rxPin] = Gpio::levelLow;
+    rxNextEdgeUs = timeUs;
+    rxSource = RxSource::Pulses;
+}
+
+void Sim::setAnalogValue(uint8_t pin, uint16_t value)
+{
+    initializePins();
+    if (pin < pinsCount)
+    {
+        analogValues[pin] = value;
+    }
+}
+
+void Sim::receiveSignal(uint8_t protocol, uint32_t value, uint8_t bitLength, uint16_t repeatCount,
+                        uint16_t pulseLengthUs)
+{
+    Protocol::Timing timing;
+    if (Protocol::getTiming(protocol, timing) == false || bitLength == 0 || bitLength > 32)
+    {
+        return;
+    }
+    if (pulseLengthUs != 0)
+    {
+        // Remote clock differs from the nominal one
+        timing.pulseLength = pulseLengthUs;
+    }
+
+    // Frame as a remote sends it: data bits MSB first, the sync follows them
+    uint16_t pulses[(32 + 1) * 2];
+    uint8_t pulsesCount = 0;
+    for (int8_t bitIdx = bitLength - 1; bitIdx >= 0; bitIdx--)
+    {
+        const Protocol::Pulses &bit = (((value >> bitIdx) & 1UL) != 0) ? timing.one : timing.zero;
+        pulses[pulsesCount++] = bit.high * timing.pulseLength;
+        pulses[pulsesCount++] = bit.low * timing.pulseLength;
+    }
+    pulses[pulsesCount++] = timing.sync.high * timing.pulseLength;
+    pulses[pulsesCount++] = timing.sync.low * timing.pulseLength;
+
+    receivePulses(pulses, pulsesCount, repeatCount);
+    stats.rfFramesReceived += repeatCount;
+}
+
+void Sim::setTxEdgeHandler(void (*handler)(uint8_t level, unsigned long long timeUs))
+{
+    txEdgeHandler = handler;
+}
+
+uint8_t *Sim::getEeprom()
+{
+    initializeEeprom();
+    return &eeprom[0];
+}
+
+void Sim::countStorageAccess(unsigned long bytesRead, unsigned long bytesWritten)
+{
+    stats.storageBytesRead += bytesRead;
+    stats.storageBytesWritten += bytesWritten;
+}
+
+const uint8_t *Sim::getFramebuffer()
+{
+    return &framebuffer[0][0];
+}
+
+void Sim::dumpScreen(FILE *file)
+{
+    fprintf(file, "+%.*s+\n", 24, "------------------------");
+    for (uint8_t page = 0; page < screenPages; page++)
+    {
+        char row[2 * screenWidth + 1];
+        uint8_t length = 0;
+        bool isInverted = false;
+        // End of the previous glyph, blank columns up to the next glyph are shown as plain spaces
+        uint8_t glyphEnd = 0;
+        for (uint8_t x = 0; x < screenWidth; x++)
+        {
+            char ch = textCells[page][x];
+            if (ch != '\0')
+            {
+                for (int gap = x - glyphEnd; gap >= textWidths[page][x]; gap -= textWidths[page][x])
+                {
+                    if (isInverted == true)
+                    {
+                        isInverted = false;
+                        row[length++] = ']';
+                    }
+                    row[length++] = ' ';
+                }
+                if (textInverted[page][x] != isInverted)
+                {
+                    isInverted = textInverted[page][x];
+                    row[length++] = isInverted ? '[' : ']';
+                }
+                glyphEnd = x + textWidths[page][x];
+                row[length++] = (ch >= ' ' && ch <= '~') ? ch : '?';
+            }
+        }
+        if (isInverted == true)
+        {
+            row[length++] = ']';
+        }
+        row[length] = '\0';
+        fprintf(file, "|%-24s|\n", row);
+    }
+    fprintf(file, "+%.*s+\n", 24, "------------------------");
+}
+
+const Sim::Stats &Sim::getStats()
+{
+    return stats;
+}
+
+void Sim::dumpProfile(FILE *file)
+{
+    for (uint8_t idx = 0; idx < measurementsCount; idx++)
+    {
+        fprintf(file, "profile: %s %lu us\n", measurements[idx].name, measurements[idx].timeUs);
+    }
+}
+
+unsigned long Hal::Clock::millis()
+{
+    // Interrupt handlers see the time of their event
+    return ((isDispatching == true) ? eventTimeUs : timeUs) / 1000;
+}
+
+unsigned long Hal::Clock::micros()
+{
+    return (isDispatching == true) ? eventTimeUs : timeUs;
+}
+
+void Hal::Clock::delay(unsigned long timeMs)
+{
+    timeUs += timeMs * 1000;
+    dispatchInterrupts();
+}
+
+void Hal::Clock::delayMicroseconds(uint16_t timeUs)
+{
+    ::timeUs += timeUs;
+    dispatchInterrupts();
+}
+
+uint8_t Hal::Interrupts::lock()
+{
+    uint8_t state = isInterruptsEnabled ? 1 : 0;
+    isInterruptsEnabled = false;
+    return state;
+}
+
+void Hal::Interrupts::restore(uint8_t state)
+{
+    isInterruptsEnabled = (state != 0);
+    if (isInterruptsEnabled == true && isDispatching == false && timeUs > interruptsFreeUs)
+    {
+        // Interrupts which came during the critical section are handled from now
+        interruptsFreeUs = timeUs;
+    }
+    dispatchInterrupts();
+}
+
+void Hal::Timer::setHandler(void (*handler)())
+{
+    timerHandler = handler;
+}
+
+uint16_t Hal::Timer::getTicks()
+{
+    return (uint16_t)(Hal::Clock::micros() * Timer::ticksPerUs);
+}
+
+void Hal::Timer::start(uint16_t delayUs)
+{
+    timerDueUs = ((isDispatching == true) ? eventTimeUs : timeUs) + delayUs;
+    isTimerEnabled = true;
+}
+
+bool Hal::Timer::scheduleNext(uint16_t delayUs)
+{
+    timerDueUs += delayUs;
+
+    unsigned long long handlerTimeUs = handlerStartUs + interruptLatencyUs;
+    if (timerDueUs <= handlerTimeUs)
+    {
+        // Compare would match after the wrap, event is moved a couple of microseconds ahead
+        timerDueUs = handlerTimeUs + 2;
+        return false;
+    }
+
+    return true;
+}
+
+void Hal::Timer::setOutputLevel(uint8_t level)
+{
+    timerOutputLevel = level;
+    isTimerOutputConnected = true;
+}
+
+uint16_t Hal::Timer::getElapsedUs()
+{
+    return (isDispatching == true) ? (handlerStartUs + interruptLatencyUs - eventTimeUs) : 0;
+}
+
+void Hal::Timer::stop()
+{
+    isTimerEnabled = false;
+    if (isTimerOutputConnected == true)
+    {
+        isTimerOutputConnected = false;
+        if (txPin == Timer::outputPin)
+        {
+            setTxLevel(Gpio::levelLow, (isDispatching == true) ? handlerStartUs + interruptLatencyUs : timeUs);
+        }
+    }
+}
+
+void Hal::Profile::report(const __FlashStringHelper *name, unsigned long timeUs)
+{
+    if (measurementsCount < measurementsMax)
+    {
+        // Program memory is the same address space as RAM on the host
+        measurements[measurementsCount++] = {reinterpret_cast<const char *>(name), timeUs};
+    }
+}
+
+int vsnprintf_P(char *buffer, size_t size, const char *format, va_list args)
+{
+    // Program memory string conversions %S are passed to the host printf as %s,
+    // formats are short display and log lines
+    char hostFormat[64];
+    size_t length = 0;
+    bool isConversion = false;
+
+    for (const char *pChar = format; *pChar != '\0' && length < sizeof(hostFormat) - 1; pChar++)
+    {
+        char ch = *pChar;
+        if (isConversion == true)
+        {
+            ch = (ch == 'S') ? 's' : ch;
+            // Flags, width and precision are followed by the conversion character
+            isConversion = (strchr("-+ #0123456789.*hlL", ch) != nullptr);
+        }
+        else if (ch == '%')
+        {
+            isConversion = true;
+        }
+        hostFormat[length++] = ch;
+    }
+    hostFormat[length] = '\0';
+
+    return vsnprintf(buffer, size, hostFormat, args);
+}
+
+int snprintf_P(char *buffer, size_t size, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int result = vsnprintf_P(buffer, size, format, args);
+    va_end(args);
+
+    return result;
+}
+
+void Hal::Gpio::setMode(uint8_t pin, Mode mode)
+{
+    initializePins();
+}
+
+uint8_t Hal::Gpio::read(uint8_t pin)
+{
+    initializePins();
+    return (pin < pinsCount) ? pinLevels[pin] : levelLow;
+}
+
+Gpio::PortPin Hal::Gpio::getPortPin(uint8_t pin)
+{
+    // Every simulated pin is a port of its own with the level in bit 0
+    static const uint8_t levelNone = levelLow;
+    initializePins();
+    return {(pin < pinsCount) ? &pinLevels[pin] : &levelNone, 1};
+}
+
+void Hal::Gpio::write(uint8_t pin, uint8_t level)
+{
+    initializePins();
+    if (pin < pinsCount)
+    {
+        pinLevels[pin] = level;
+    }
+}
+
+void Hal::Gpio::attachInterrupt(uint8_t interrupt, void (*handler)())
+{
+    if (interrupt < interruptsCount)
+    {
+        edgeHandlers[interrupt] = handler;
+    }
+}
+
+void Hal::Gpio::detachInterrupt(uint8_t interrupt)
+{
+    if (interrupt < interruptsCount)
+    {
+        edgeHandlers[interrupt] = nullptr;
+    }
+}
+
+uint16_t Hal::Gpio::readAnalog(uint8_t pin)
+{
+    initializePins();
+    timeUs += analogReadTimeUs;
+    return (pin < pinsCount) ? analogValues[pin] : 0;
+}
+
+void Hal::Serial::initialize(unsigned long baudRate)
+{
+}
+
+void Hal::Serial::println(const char *text)
+{
+    stats.serialBytes += strlen(text) + 2;
+}
+
+void Hal::Spi::initialize(unsigned long clockHz)
+{
+}
+
+uint8_t Hal::Spi::transfer(uint8_t value)
+{
+    // Nothing is connected, MISO is pulled up
+    return 0xFF;
+}
+
+uint8_t Hal::Eeprom::read(int address)
+{
+    initializeEeprom();
+    stats.eepromReads++;
+    timeUs += eepromReadTimeUs;
+    return (address >= 0 && address < Sim::eepromSize) ? eeprom[address] : 0xFF;
+}
+
+void Hal::Eeprom::write(int address, uint8_t value)
+{
+    initializeEeprom();
+    stats.eepromWrites++;
+    timeUs += eepromWriteTimeUs;
+    if (address >= 0 && address < Sim::eepromSize)
+    {
+        eeprom[address] = value;
+    }
+}
+
+bool Hal::Eeprom::isReady()
+{
+    bool isReady = (eepromBusyUntilUs <= timeUs);
+    if (isReady == false)
+    {
+        // Polling loop takes time on the real hardware
+        timeUs += eepromPollTimeUs;
+    }
+    return isReady;
+}
+
+void Hal::Eeprom::startWrite(int address, uint8_t value)
+{
+    initializeEeprom();
+    stats.eepromWrites++;
+    // Writes from the interrupt start right when the previous one completes
+    unsigned long long startUs = (isDispatching == true || eepromBusyUntilUs > timeUs) ? eepromBusyUntilUs : timeUs;
+    eepromBusyUntilUs = startUs + eepromWriteTimeUs;
+    if (address >= 0 && address < Sim::eepromSize)
+    {
+        eeprom[address] = value;
+    }
+}
+
+void Hal::Eeprom::setReadyHandler(void (*handler)())
+{
+    eepromReadyHandler = handler;
+}
+
+void Hal::Eeprom::enableReadyInterrupt(bool isEnabled)
+{
+    if (isEnabled == true && isEepromReadyInterruptEnabled == false && eepromBusyUntilUs < timeUs)
+    {
+        // EEPROM has been idle, first interrupt fires now
+        eepromBusyUntilUs = timeUs;
+    }
+    isEepromReadyInterruptEnabled = isEnabled;
+    dispatchInterrupts();
+}
+
+void Hal::Screen::initialize()
+{
+    screenFont = Font::Font_6x8;
+    isScreenInverted = false;
+}
+
+void Hal::Screen::clear()
+{
+    memset(framebuffer, 0, sizeof(framebuffer));
+    memset(textCells, 0, sizeof(textCells));
+    queueScreenBytes(Sim::screenPages * (i2cPageSetupBytes + Sim::screenWidth));
+}
+
+void Hal::Screen::setFont(Font font)
+{
+    screenFont = font;
+}
+
+void Hal::Screen::setInverted(bool isInverted)
+{
+    isScreenInverted = isInverted;
+}
+
+void Hal::Screen::print(uint8_t xPos, uint8_t yPos, const char *text, Style style)
+{
+    const uint8_t charWidth = (screenFont == Font::Font_8x16) ? 8 : 6;
+    const uint8_t charPages = (screenFont == Font::Font_8x16) ? 2 : 1;
+    const uint8_t invertMask = isScreenInverted ? 0xFF : 0x00;
+    const uint8_t page = yPos / 8;
+
+    uint8_t xEnd = xPos;
+    for (const char *pCh = text; *pCh != '\0' && xEnd + charWidth <= Sim::screenWidth; pCh++)
+    {
+        for (uint8_t pageOffset = 0; pageOffset < charPages && page + pageOffset < Sim::screenPages; pageOffset++)
+        {
+            // Deterministic stand-in for the glyph bitmap
+            for (uint8_t col = 0; col < charWidth; col++)
+            {
+                uint8_t bits = (uint8_t)(*pCh * (col + 1) + pageOffset * 0x55 + (uint8_t)style);
+                framebuffer[page + pageOffset][xEnd + col] = bits ^ invertMask;
+            }
+            clearCells(page + pageOffset, xEnd, xEnd + charWidth);
+        }
+
+        textCells[page][xEnd] = *pCh;
+        textWidths[page][xEnd] = charWidth;
+        textInverted[page][xEnd] = isScreenInverted;
+        xEnd += charWidth;
+    }
+
+    queueScreenBytes(charPages * (i2cPageSetupBytes + (xEnd - xPos)));
+}
+
+void Hal::Screen::flush()
+{
+    if (screenIdleUs > timeUs)
+    {
+        timeUs = screenIdleUs;
+    }
+}
+
+void Hal::Rf::enableTransmit(uint8_t pin)
+{
+    txPin = pin;
+    txLevel = Gpio::levelLow;
+}
+
+void Hal::Rf::setTransmitLevel(uint8_t level)
+{
+    // Pin written from the interrupt changes after the handler entry
+    setTxLevel(level, (isDispatching == true) ? handlerStartUs + interruptLatencyUs : timeUs);
+}
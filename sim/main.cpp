@@ -0,0 +1,381 @@
+#include "sim.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+// Firmware entry points
+void setup();
+void loop();
+
+namespace
+{
+    // Frames sent by a remote on a button press unless set by the script
+    constexpr unsigned long rxRepeatDefault = 4;
+
+    /**
+     * @brief Scripted hardware event
+     */
+    struct Event
+    {
+        enum class Type
+        {
+            Pin,
+            Analog,
+            Rx,
+            Noise,
+            Pulses,
+            Dump,
+        };
+
+        unsigned long long timeUs;
+        Type type;
+        uint8_t pin;
+        uint32_t value;
+        uint8_t protocol;
+        uint8_t bitLength;
+        uint16_t repeatCount;
+        uint16_t pulseLengthUs;
+        unsigned long intervalUs;
+        std::vector<uint16_t> pulses;
+    };
+
+    void printUsage(const char *name)
+    {
+        fprintf(stderr,
+                "Usage: %s [-n iterations] [-t loop_time_us] [-s script] [-e eeprom_image] [-f storage_file] [-q]\n"
+                "\n"
+                "Script lines (times in milliseconds since startup):\n"
+                "  <ms> pin <pin> <level>             set digital input level\n"
+                "  <ms> press <pin> <duration_ms>     pull button pin low for duration\n"
+                "  <ms> analog <pin> <value>          set raw ADC value\n"
+                "  <ms> rx <protocol> <value> <bits> [repeat] [pulse_us]\n"
+                "                                     play signal frames on RX pin, %lu frames by default,\n"
+                "                                     with the protocol pulse length by default\n"
+                "  <ms> noise <duration_ms> <us>      toggle RX pin with mean edge interval\n"
+                "  <ms> pulses <repeat> <us>...       play pulse train on RX pin, the first pulse is high\n"
+                "  <ms> dump                          print screen content\n",
+                name, rxRepeatDefault);
+    }
+
+    bool loadScript(const char *fileName, std::vector<Event> &events)
+    {
+        FILE *file = fopen(fileName, "r");
+        if (file == nullptr)
+        {
+            perror(fileName);
+            return false;
+        }
+
+        char line[512];
+        unsigned lineNumber = 0;
+        while (fgets(line, sizeof(line), file) != nullptr)
+        {
+            lineNumber++;
+
+            char *comment = strchr(line, '#');
+            if (comment != nullptr)
+            {
+                *comment = '\0';
+            }
+
+            unsigned long timeMs = 0;
+            char command[16] = {0};
+            unsigned long args[5] = {0};
+            int count = sscanf(line, "%lu %15s %li %li %li %li %li", &timeMs, command, &args[0], &args[1], &args[2],
+                               &args[3], &args[4]);
+            if (count <= 0)
+            {
+                continue;
+            }
+
+            Event event = {};
+            event.timeUs = timeMs * 1000ULL;
+            if (strcmp(command, "pin") == 0 && count == 4)
+            {
+                event.type = Event::Type::Pin;
+                event.pin = args[0];
+                event.value = args[1];
+                events.push_back(event);
+            }
+            else if (strcmp(command, "press") == 0 && count == 4)
+            {
+                event.type = Event::Type::Pin;
+                event.pin = args[0];
+                event.value = 0;
+                events.push_back(event);
+                event.timeUs += args[1] * 1000ULL;
+                event.value = 1;
+                events.push_back(event);
+            }
+            else if (strcmp(command, "analog") == 0 && count == 4)
+            {
+                event.type = Event::Type::Analog;
+                event.pin = args[0];
+                event.value = args[1];
+                events.push_back(event);
+            }
+            else if (strcmp(command, "rx") == 0 && count >= 5 && count <= 7)
+            {
+                event.type = Event::Type::Rx;
+                event.protocol = args[0];
+                event.value = args[1];
+                event.bitLength = args[2];
+                event.repeatCount = (count >= 6) ? args[3] : rxRepeatDefault;
+                event.pulseLengthUs = (count == 7) ? args[4] : 0;
+                events.push_back(event);
+            }
+            else if (strcmp(command, "noise") == 0 && count == 4)
+            {
+                event.type = Event::Type::Noise;
+                event.value = args[0];
+                event.intervalUs = args[1];
+                events.push_back(event);
+            }
+            else if (strcmp(command, "pulses") == 0 && count >= 4)
+            {
+                event.type = Event::Type::Pulses;
+                event.value = args[0];
+                // Durations follow the repeat count up to the end of line
+                char *pos = strstr(line, "pulses") + strlen("pulses");
+                strtoul(pos, &pos, 0);
+                char *end;
+                for (unsigned long durationUs = strtoul(pos, &end, 0); end != pos; durationUs = strtoul(pos, &end, 0))
+                {
+                    event.pulses.push_back(durationUs);
+                    pos = end;
+                }
+                events.push_back(event);
+            }
+            else if (strcmp(command, "dump") == 0 && count == 2)
+            {
+                event.type = Event::Type::Dump;
+                events.push_back(event);
+            }
+            else
+            {
+                fprintf(stderr, "%s:%u: invalid event\n", fileName, lineNumber);
+                fclose(file);
+                return false;
+            }
+        }
+
+        fclose(file);
+
+        std::stable_sort(events.begin(), events.end(),
+                         [](const Event &a, const Event &b)
+                         { return a.timeUs < b.timeUs; });
+        return true;
+    }
+
+    void applyEvent(const Event &event)
+    {
+        switch (event.type)
+        {
+        case Event::Type::Pin:
+            Sim::setPinLevel(event.pin, event.value);
+            break;
+
+        case Event::Type::Analog:
+            Sim::setAnalogValue(event.pin, event.value);
+            break;
+
+        case Event::Type::Rx:
+            Sim::receiveSignal(event.protocol, event.value, event.bitLength, event.repeatCount, event.pulseLengthUs);
+            break;
+
+        case Event::Type::Noise:
+            Sim::receiveNoise(event.value, event.intervalUs);
+            break;
+
+        case Event::Type::Pulses:
+            Sim::receivePulses(event.pulses.data(), event.pulses.size(), event.value);
+            break;
+
+        case Event::Type::Dump:
+            printf("t=%llums\n", Sim::getTime() / 1000);
+            Sim::dumpScreen(stdout);
+            break;
+        }
+    }
+
+    bool loadEeprom(const char *fileName)
+    {
+        FILE *file = fopen(fileName, "rb");
+        if (file == nullptr)
+        {
+            // Start with erased EEPROM
+            return true;
+        }
+
+        size_t size = fread(Sim::getEeprom(), 1, Sim::eepromSize, file);
+        fclose(file);
+        return size == Sim::eepromSize;
+    }
+
+    bool saveEeprom(const char *fileName)
+    {
+        FILE *file = fopen(fileName, "wb");
+        if (file == nullptr)
+        {
+            perror(fileName);
+            return false;
+        }
+
+        size_t size = fwrite(Sim::getEeprom(), 1, Sim::eepromSize, file);
+        fclose(file);
+        return size == Sim::eepromSize;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    unsigned long iterations = 100000;
+    unsigned long loopTimeUs = 100;
+    const char *scriptFileName = nullptr;
+    const char *eepromFileName = nullptr;
+    const char *storageFileName = nullptr;
+    bool isQuiet = false;
+
+    int option;
+    while ((option = getopt(argc, argv, "n:t:s:e:f:qh")) != -1)
+    {
+        switch (option)
+        {
+        case 'n':
+            iterations = strtoul(optarg, nullptr, 0);
+            break;
+
+        case 't':
+            loopTimeUs = strtoul(optarg, nullptr, 0);
+            break;
+
+        case 's':
+            scriptFileName = optarg;
+            break;
+
+        case 'e':
+            eepromFileName = optarg;
+            break;
+
+        case 'f':
+            storageFileName = optarg;
+            break;
+
+        case 'q':
+            isQuiet = true;
+            break;
+
+        default:
+            printUsage(argv[0]);
+            return (option == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    std::vector<Event> events;
+    if (scriptFileName != nullptr && loadScript(scriptFileName, events) == false)
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (eepromFileName != nullptr && loadEeprom(eepromFileName) == false)
+    {
+        fprintf(stderr, "%s: invalid EEPROM image\n", eepromFileName);
+        return EXIT_FAILURE;
+    }
+
+#ifdef STORAGE_FILE
+    Sim::setStorageFile(storageFileName);
+#else
+    if (storageFileName != nullptr)
+    {
+        fprintf(stderr, "%s: external storage is not used by this build (make STORAGE=file)\n", storageFileName);
+        return EXIT_FAILURE;
+    }
+#endif // STORAGE_FILE
+
+    std::vector<uint32_t> hostTimesNs;
+    hostTimesNs.reserve(iterations);
+    unsigned long long simBusyTimeUs = 0;
+    unsigned long long simBusyTimeMaxUs = 0;
+
+    auto setupStart = std::chrono::steady_clock::now();
+    setup();
+    auto setupEnd = std::chrono::steady_clock::now();
+    unsigned long long setupSimTimeUs = Sim::getTime();
+
+    size_t eventIdx = 0;
+    for (unsigned long iteration = 0; iteration < iterations; iteration++)
+    {
+        while (eventIdx < events.size() && events[eventIdx].timeUs <= Sim::getTime())
+        {
+            applyEvent(events[eventIdx++]);
+        }
+
+        unsigned long long simStartUs = Sim::getTime();
+        auto start = std::chrono::steady_clock::now();
+        loop();
+        auto end = std::chrono::steady_clock::now();
+
+        hostTimesNs.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+
+        // Time spent in modeled blocking hardware operations
+        unsigned long long busyUs = Sim::getTime() - simStartUs;
+        simBusyTimeUs += busyUs;
+        simBusyTimeMaxUs = std::max(simBusyTimeMaxUs, busyUs);
+
+        Sim::advance(loopTimeUs);
+    }
+
+    while (eventIdx < events.size())
+    {
+        applyEvent(events[eventIdx++]);
+    }
+
+    if (eepromFileName != nullptr && saveEeprom(eepromFileName) == false)
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (isQuiet == false)
+    {
+        Sim::dumpScreen(stdout);
+    }
+
+    const Sim::Stats &stats = Sim::getStats();
+    printf("setup: host %.3f ms, simulated %llu ms\n",
+           std::chrono::duration<double, std::milli>(setupEnd - setupStart).count(), setupSimTimeUs / 1000);
+
+    Sim::dumpProfile(stdout);
+
+    if (iterations > 0)
+    {
+        unsigned long long hostTotalNs = 0;
+        for (uint32_t timeNs : hostTimesNs)
+        {
+            hostTotalNs += timeNs;
+        }
+        std::vector<uint32_t> sorted = hostTimesNs;
+        std::sort(sorted.begin(), sorted.end());
+
+        printf("loop: %lu iterations, simulated %llu ms\n", iterations, Sim::getTime() / 1000);
+        printf("loop host time: avg %llu ns, p99 %u ns, max %u ns\n",
+               hostTotalNs / iterations, sorted[(iterations - 1) * 99 / 100], sorted.back());
+        printf("loop busy time: avg %llu us, max %llu us\n", simBusyTimeUs / iterations, simBusyTimeMaxUs);
+    }
+
+    printf("i2c: %lu bytes, eeprom: %lu reads %lu writes, rf: %lu tx edges %lu rx frames, serial: %lu bytes\n",
+           stats.i2cBytes, stats.eepromReads, stats.eepromWrites,
+           stats.rfTxEdges, stats.rfFramesReceived, stats.serialBytes);
+#ifdef STORAGE_FILE
+    printf("storage: %lu bytes read, %lu bytes written\n", stats.storageBytesRead, stats.storageBytesWritten);
+#endif // STORAGE_FILE
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Host simulator controls
+ *
+ * Drives the simulated hardware behind the Hal interface: clock, GPIO levels, radio feed,
+ * RAM-backed EEPROM, file-backed external storage and 128x64 framebuffer.
+ */
+namespace Sim
+{
+    // Screen geometry
+    static constexpr uint8_t screenWidth = 128;
+    static constexpr uint8_t screenPages = 8;
+    // EEPROM size of ATmega328P
+    static constexpr int eepromSize = 1024;
+    // Maximum number of pulses in the received pulse train
+    static constexpr uint8_t rxPulsesMax = 128;
+
+    /**
+     * @brief Simulated hardware counters
+     */
+    struct Stats
+    {
+        unsigned long i2cBytes;
+        unsigned long eepromReads;
+        unsigned long eepromWrites;
+        unsigned long storageBytesRead;
+        unsigned long storageBytesWritten;
+        unsigned long rfTxEdges;
+        unsigned long rfFramesReceived;
+        unsigned long serialBytes;
+    };
+
+    /**
+     * @brief Advance simulated clock
+     *
+     * @param timeUs Time to advance, microseconds
+     */
+    void advance(unsigned long timeUs);
+
+    /**
+     * @brief Return simulated time since startup
+     *
+     * @return Time, microseconds
+     */
+    unsigned long long getTime();
+
+    /**
+     * @brief Set digital level of the input pin
+     *
+     * @param pin Pin number
+     * @param level New pin level
+     */
+    void setPinLevel(uint8_t pin, uint8_t level);
+
+    /**
+     * @brief Set raw ADC value of the analog pin
+     *
+     * @param pin Pin number
+     * @param value Raw ADC value
+     */
+    void setAnalogValue(uint8_t pin, uint16_t value);
+
+    /**
+     * @brief Play frames of the signal on the RX pin, edges are passed to the attached interrupt
+     * Frames are sent back-to-back with the protocol timing, pin is low after the last one
+     *
+     * @param protocol Protocol number
+     * @param value Signal value
+     * @param bitLength Signal bit length
+     * @param repeatCount Number of frames
+     * @param pulseLengthUs Pulse length of the remote, microseconds, 0 for the protocol one
+     */
+    void receiveSignal(uint8_t protocol, uint32_t value, uint8_t bitLength, uint16_t repeatCount,
+                       uint16_t pulseLengthUs = 0);
+
+    /**
+     * @brief Toggle RX pin at random intervals, edges are passed to the attached interrupt
+     *
+     * @param durationMs Noise duration, milliseconds
+     * @param intervalUs Mean interval between edges, microseconds
+     */
+    void receiveNoise(unsigned long durationMs, unsigned long intervalUs);
+
+    /**
+     * @brief Play pulse train on the RX pin, edges are passed to the attached interrupt
+     * The first pulse is high, pin is low after the last repeat
+     *
+     * @param pulses Pulse durations, microseconds
+     * @param pulsesCount Number of pulses (up to rxPulsesMax)
+     * @param repeatCount Number of pulse train repeats
+     */
+    void receivePulses(const uint16_t *pulses, uint8_t pulsesCount, uint16_t repeatCount);
+
+    /**
+     * @brief Set handler called on every TX carrier edge, e.g. to loop it back to a receiver
+     * Edge time is when the pin changes: the compare match for the timer output,
+     * the handler entry for the pin written from the interrupt
+     *
+     * @param handler Edge handler, nullptr to remove it
+     */
+    void setTxEdgeHandler(void (*handler)(uint8_t level, unsigned long long timeUs));
+
+    /**
+     * @brief Return EEPROM content (eepromSize bytes)
+     */
+    uint8_t *getEeprom();
+
+    /**
+     * @brief Set file backing the external storage (STORAGE_FILE build)
+     * Should be called before the firmware setup, storage is kept in RAM if not set
+     *
+     * @param fileName Storage file name, created if not exists
+     */
+    void setStorageFile(const char *fileName);
+
+    /**
+     * @brief Count external storage access
+     *
+     * @param bytesRead Number of bytes read
+     * @param bytesWritten Number of bytes written
+     */
+    void countStorageAccess(unsigned long bytesRead, unsigned long bytesWritten);
+
+    /**
+     * @brief Return framebuffer content (screenPages x screenWidth bytes)
+     */
+    const uint8_t *getFramebuffer();
+
+    /**
+     * @brief Print text content of the screen
+     *
+     * @param file Output file
+     */
+    void dumpScreen(FILE *file);
+
+    /**
+     * @brief Print times reported by the firmware through Hal::Profile
+     *
+     * @param file Output file
+     */
+    void dumpProfile(FILE *file);
+
+    /**
+     * @brief Return simulated hardware counters
+     */
+    const Stats &getStats();
+} // namespace Sim
@@ -0,0 +1,126 @@
+#include "storage.h"
+#include "sim.h"
+
+#ifdef STORAGE_FILE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "hal.h"
+
+using namespace Storage;
+
+namespace
+{
+    // Modeled SPI memory costs, microseconds
+    constexpr unsigned long spiByteTimeUs = 1;    // 8 MHz SPI clock
+    constexpr unsigned long commandBytes = 3;     // Command and address per access
+
+    uint8_t memory[Storage::size];
+    FILE *pFile = nullptr;
+    const char *fileName = nullptr;
+
+    /**
+     * @brief Account SPI transfer of the access
+     *
+     * @param length Data length, bytes
+     */
+    void transfer(uint16_t length)
+    {
+        Hal::Clock::delayMicroseconds((commandBytes + length) * spiByteTimeUs);
+    }
+
+    /**
+     * @brief Write memory range through to the file
+     *
+     * @param address Range start address
+     * @param length Range length, bytes
+     */
+    void writeThrough(uint32_t address, uint16_t length)
+    {
+        if (pFile != nullptr)
+        {
+            fseek(pFile, address, SEEK_SET);
+            fwrite(&memory[address], 1, length, pFile);
+            fflush(pFile);
+        }
+    }
+
+    /**
+     * @brief Check if the range is inside the storage
+     */
+    inline bool isValid(uint32_t address, uint16_t length)
+    {
+        return address + length <= Storage::size;
+    }
+} // namespace
+
+void Sim::setStorageFile(const char *fileName)
+{
+    ::fileName = fileName;
+}
+
+void Storage::initialize()
+{
+    // Erased memory reads as 0xFF
+    memset(memory, 0xFF, sizeof(memory));
+
+    if (fileName != nullptr)
+    {
+        pFile = fopen(fileName, "r+b");
+        if (pFile != nullptr)
+        {
+            fread(memory, 1, sizeof(memory), pFile);
+        }
+        else
+        {
+            pFile = fopen(fileName, "w+b");
+            writeThrough(0, sizeof(memory));
+        }
+    }
+}
+
+void Storage::read(uint32_t address, void *data, uint16_t length)
+{
+    transfer(length);
+    if (isValid(address, length) == true)
+    {
+        memcpy(data, &memory[address], length);
+        Sim::countStorageAccess(length, 0);
+    }
+}
+
+void Storage::write(uint32_t address, const void *data, uint16_t length)
+{
+    transfer(length);
+    if (isValid(address, length) == true)
+    {
+        memcpy(&memory[address], data, length);
+        writeThrough(address, length);
+        Sim::countStorageAccess(0, length);
+    }
+}
+
+void Storage::fill(uint32_t address, uint8_t value, uint16_t length)
+{
+    transfer(length);
+    if (isValid(address, length) == true)
+    {
+        memset(&memory[address], value, length);
+        writeThrough(address, length);
+        Sim::countStorageAccess(0, length);
+    }
+}
+
+bool Storage::isPending()
+{
+    return false;
+}
+
+void Storage::flush()
+{
+}
+
+#endif // STORAGE_FILE
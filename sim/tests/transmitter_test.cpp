@@ -0,0 +1,141 @@
+// Transmitter queue test
+//
+// Signals are queued at the moments the queue state changes: while the transmitter is idle, while
+// a frame is sent, during the last pulse of the last queued frame and during the gap after it.
+// In the last two the queue is already empty but the transmitter is still busy, the signal queued
+// then should follow the one being sent. Every case is run with both carrier outputs.
+
+#include "hal.h"
+#include "sim.h"
+#include "slot.h"
+#include "transmitter.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+namespace
+{
+    // Longest time to wait for a queue state, microseconds
+    constexpr unsigned long waitTimeMaxUs = 2000000;
+    constexpr unsigned long stepUs = 50;
+    constexpr Slot::Signal signal = {0x00ABCDEF, 1, 24, 0};
+
+    /**
+     * @brief Queue state to wait for before the second signal is queued
+     */
+    enum class Moment
+    {
+        Idle,
+        Frame,
+        LastPulse,
+        Gap,
+    };
+
+    constexpr Moment moments[] = {Moment::Idle, Moment::Frame, Moment::LastPulse, Moment::Gap};
+    const char *momentNames[] = {"idle", "frame", "last pulse", "gap"};
+
+    unsigned txEdgesCount = 0;
+
+    void onTxEdge(uint8_t level, unsigned long long timeUs)
+    {
+        txEdgesCount++;
+    }
+
+    /**
+     * @brief Advance time until the transmitter is in the queue state
+     *
+     * @param moment Queue state
+     * @return true if state is reached, false if the transmitter became idle or time is out
+     */
+    bool waitFor(Moment moment)
+    {
+        for (unsigned long timeUs = 0; timeUs < waitTimeMaxUs; timeUs += stepUs)
+        {
+            bool isEmpty = (Transmitter::getQueuedCount() == 0);
+            switch (moment)
+            {
+            case Moment::Idle:
+                if (Transmitter::isBusy() == false)
+                {
+                    return true;
+                }
+                break;
+
+            case Moment::Frame:
+                if (isEmpty == false)
+                {
+                    return true;
+                }
+                break;
+
+            case Moment::LastPulse:
+            case Moment::Gap:
+                if (isEmpty == true)
+                {
+                    return Transmitter::isBusy();
+                }
+                break;
+            }
+            Sim::advance(stepUs);
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Queue two signals, the second one at the moment, and wait until both are sent
+     *
+     * @param moment Queue state when the second signal is queued
+     * @param edgesCount Carrier edges of one frame
+     * @return true if both signals are sent, false otherwise
+     */
+    bool run(Moment moment, uint8_t edgesCount)
+    {
+        uint16_t framesStart = Transmitter::getFramesSent();
+        txEdgesCount = 0;
+        uint16_t gapMs = (moment == Moment::Gap) ? 20 : 0;
+
+        bool isQueued = Transmitter::enqueue(signal, 1, gapMs);
+        isQueued = (isQueued == true && waitFor(moment) == true);
+        isQueued = (isQueued == true && Transmitter::enqueue(signal, 1, 0) == true);
+        bool isIdle = waitFor(Moment::Idle);
+
+        uint16_t frames = Transmitter::getFramesSent() - framesStart;
+        uint8_t queued = Transmitter::getQueuedCount();
+        bool isPassed = (isQueued == true && isIdle == true && frames == 2 && queued == 0 &&
+                         txEdgesCount == 2U * edgesCount);
+
+        printf("  second signal queued at %-10s frames=%u busy=%u queued=%u edges=%u  %s\n", momentNames[(int)moment],
+               frames, Transmitter::isBusy() ? 1 : 0, queued, txEdgesCount, isPassed ? "ok" : "FAILED");
+
+        return isPassed;
+    }
+} // namespace
+
+int main()
+{
+    Transmitter::initialize(Hal::Timer::outputPin);
+    Sim::setTxEdgeHandler(onTxEdge);
+
+    // Frame starts high and ends low, every pulse starts with an edge
+    Transmitter::Waveform waveform;
+    Transmitter::encode(signal, waveform);
+
+    const Transmitter::Output outputs[] = {Transmitter::Output::Timer, Transmitter::Output::Interrupt};
+    unsigned failedCount = 0;
+
+    for (Transmitter::Output output : outputs)
+    {
+        Transmitter::setOutput(output);
+        printf("%s output:\n", (output == Transmitter::Output::Timer) ? "timer" : "interrupt");
+
+        for (Moment moment : moments)
+        {
+            failedCount += (run(moment, waveform.pulsesCount) == true) ? 0 : 1;
+        }
+    }
+
+    printf("%s\n", (failedCount == 0) ? "all passed" : "FAILED");
+
+    return (failedCount == 0) ? 0 : 1;
+}
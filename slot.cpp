@@ -1,12 +1,16 @@
 #include "slot.h"
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
-#include <CRC.h>
-#include <EEPROM.h>
-
+#include "crc8.h"
+#include "hal.h"
+#include "journal.h"
 #include "log.h"
+#include "protocol.h"
+#include "storage.h"
 
 // #define LOG_DEBUG // Uncomment to enable log printing
 
@@ -14,20 +18,108 @@ using namespace Slot;
 
 namespace
 {
+    // Stored pulse length is a 6-bit code of its ratio to the protocol one: (code + 32) / 64,
+    // code 0 stands for the protocol pulse length
+    constexpr uint8_t pulseCodeMax = 63;
+    constexpr uint8_t pulseCodeOffset = 32;
+    constexpr uint8_t pulseCodeScale = 64;
+
 #pragma pack(push, 1)
+    /**
+     * @brief Stored signal structure, same layout as the signal of firmware v0.5
+     * Pulse length code takes the high bits protocol number and bit length never use,
+     * so signals stored without it are sent with the protocol pulse length
+     */
+    struct PackedSignal
+    {
+        uint32_t value;
+        uint8_t protocol;  // Protocol number in bits 0-3, code bits 2-5 in bits 4-7, raw protocol as is
+        uint8_t bitLength; // Bit length in bits 0-5, code bits 0-1 in bits 6-7
+    };
+
     /**
      * @brief Slot item structure
      */
     struct SlotItem
+    {
+        uint8_t name[packedNameSize];
+        PackedSignal signal;
+    };
+
+    /**
+     * @brief Slot item structure of firmware v0.5
+     */
+    struct LegacySlotItem
     {
         char name[nameLengthMax + 1]; // + 1 for end of line
-        Signal signal;
+        PackedSignal signal;
     };
 #pragma pack(pop)
 
-    // Slot item size + CRC size
-    constexpr uint8_t slotStorageSize = sizeof(SlotItem) + sizeof(uint8_t);
-    static_assert(slotStorageSize == 20);
+    static_assert(nameCharsCount == 63);
+    static_assert(Protocol::count < 0x0F && rawProtocol == 0xFF);
+    static_assert(rawFrameSizeMax <= 0x3F);
+    static_assert(sizeof(SlotItem) == Journal::dataSize);
+    static_assert(slotsCount + rawFramesCount * rawFrameRecords + settingsRecords <= Journal::keysCount);
+    static_assert(sizeof(Settings) <= Journal::dataSize);
+
+    // Slot item size + CRC size in the fixed-address EEPROM layout of firmware v0.5
+    constexpr uint8_t legacySlotStorageSize = sizeof(LegacySlotItem) + sizeof(uint8_t);
+    constexpr uint8_t legacySlotsCount = 10;
+    static_assert(legacySlotStorageSize == 20);
+    static_assert(legacySlotsCount <= slotsCount);
+
+    /**
+     * @brief Pack signal to store it in the slot item
+     *
+     * @param signal Signal to pack
+     * @param packed Object to store the packed signal
+     */
+    void packSignal(const Signal &signal, PackedSignal &packed)
+    {
+        packed = {signal.value, signal.protocol, signal.bitLength};
+
+        Protocol::Timing timing;
+        if (signal.pulseLengthUs == 0 || isRaw(signal) == true ||
+            Protocol::getTiming(signal.protocol, timing) == false)
+        {
+            return;
+        }
+
+        // Rounded ratio, codes out of range are clamped to the shortest and the longest pulse
+        uint32_t ratio = ((uint32_t)signal.pulseLengthUs * pulseCodeScale + timing.pulseLength / 2) / timing.pulseLength;
+        uint8_t code = (ratio <= pulseCodeOffset) ? 1 : (ratio - pulseCodeOffset);
+        code = (code > pulseCodeMax) ? pulseCodeMax : code;
+        packed.protocol |= (code >> 2) << 4;
+        packed.bitLength |= (code & 0x03) << 6;
+    }
+
+    /**
+     * @brief Unpack signal packed by packSignal()
+     *
+     * @param packed Packed signal
+     * @param signal Object to store the signal
+     */
+    void unpackSignal(const PackedSignal &packed, Signal &signal)
+    {
+        if (packed.protocol == rawProtocol)
+        {
+            signal = {packed.value, packed.protocol, packed.bitLength, 0};
+            return;
+        }
+
+        signal = {packed.value, (uint8_t)(packed.protocol & 0x0F), (uint8_t)(packed.bitLength & 0x3F), 0};
+
+        uint8_t code = ((packed.protocol >> 4) << 2) | (packed.bitLength >> 6);
+        Protocol::Timing timing;
+        if (code != 0 && Protocol::getTiming(signal.protocol, timing) == true)
+        {
+            signal.pulseLengthUs = (uint32_t)timing.pulseLength * (code + pulseCodeOffset) / pulseCodeScale;
+        }
+    }
+
+    // Cached slot items, enough for a menu page with the slot being edited
+    constexpr uint8_t cacheSize = (slotsCount < 8) ? slotsCount : 8;
 
     /**
      * @brief Save slot item to the storage
@@ -37,70 +129,427 @@ namespace
      */
     void save(uint8_t slotIdx, const SlotItem &item)
     {
-        int slotAddress = slotIdx * slotStorageSize;
-        int crc8Address = slotAddress + sizeof(SlotItem);
-        uint8_t crc8 = calcCRC8((const uint8_t *)&item, sizeof(item));
-
 #ifdef LOG_DEBUG
-        Log::printf("Save slot[%u]: \"%s\" %02u 0x%02lX/%u", slotIdx, item.name,
+        char name[nameLengthMax + 1];
+        unpackName(item.name, name);
+        Log::printf(F("Save slot[%u]: \"%s\" %02u 0x%02lX/%u"), slotIdx, name,
                     item.signal.protocol, item.signal.value, item.signal.bitLength);
 #endif // LOG_DEBUG
 
-        EEPROM.put(slotAddress, item);
-        EEPROM.put(crc8Address, crc8);
+        Journal::write(slotIdx, &item);
+    }
+
+    /**
+     * @brief Slot cache entry states
+     */
+    enum class CacheState : uint8_t
+    {
+        Empty, // not loaded from the storage yet
+        Clean, // same as on the storage
+        Dirty, // modified, should be flushed to the storage
+    };
+
+    /**
+     * @brief Slot cache entry structure
+     */
+    struct CacheEntry
+    {
+        SlotItem item;
+        uint8_t slotIdx;
+        CacheState state;
+    };
+
+    // Recently used slot items, validated once and then served from RAM
+    CacheEntry cache[cacheSize];
+    // Entry to be replaced next
+    uint8_t cacheReplaceIdx = 0;
+
+    /**
+     * @brief Slot update transaction structure
+     */
+    struct Transaction
+    {
+        uint8_t slotIdx;
+        SlotItem item;
+    };
+
+    // Current update transaction
+    Transaction transaction = {invalidIdx};
+
+    /**
+     * @brief Return journal key of the raw frame record
+     *
+     * @param frameIdx Raw frame index
+     * @param recordIdx Record index within the frame
+     * @return Journal key
+     */
+    inline uint8_t getRawFrameKey(uint8_t frameIdx, uint8_t recordIdx)
+    {
+        return slotsCount + frameIdx * rawFrameRecords + recordIdx;
+    }
+
+    // Journal key of the settings record
+    constexpr uint8_t settingsKey = slotsCount + rawFramesCount * rawFrameRecords;
+
+    // Signal fingerprint of each slot, built on the first search
+    uint8_t signalIndex[slotsCount];
+    bool isSignalIndexBuilt = false;
+
+    // Index RAM budget of the slots and their journal records, the rest of the 2 KB SRAM is taken by
+    // the display shadow, radio buffers and the stack
+    constexpr uint16_t indexRamMax = 256;
+    static_assert(sizeof(signalIndex) + Journal::indexRamSize <= indexRamMax);
+
+    /**
+     * @brief Return signal fingerprint for the index
+     *
+     * @param signal Signal to hash
+     * @return Signal hash, 0 for invalid signal only
+     */
+    uint8_t getFingerprint(const Signal &signal)
+    {
+        if (signal == signalInvalid)
+        {
+            return 0;
+        }
+
+        // Measured pulse length doesn't make signals different
+        uint8_t hash = Crc8::calculate(&signal, offsetof(Signal, pulseLengthUs));
+        return (hash == 0) ? 1 : hash;
+    }
+
+    /**
+     * @brief Update signal index entry of the slot
+     *
+     * @param slotIdx Slot identifier
+     * @param signal New slot signal
+     */
+    inline void updateSignalIndex(uint8_t slotIdx, const Signal &signal)
+    {
+        signalIndex[slotIdx] = getFingerprint(signal);
+    }
+
+    /**
+     * @brief Update signal index entry of the slot with the stored signal
+     *
+     * @param slotIdx Slot identifier
+     * @param packed Stored slot signal
+     */
+    inline void updateSignalIndex(uint8_t slotIdx, const PackedSignal &packed)
+    {
+        Signal signal;
+        unpackSignal(packed, signal);
+        updateSignalIndex(slotIdx, signal);
     }
 
     /**
      * @brief Reset slot item to default values
      *
      * @param slotIdx Slot identifier
-     * @param item Slot item to save
+     * @param item Slot item to reset
      */
     void reset(uint8_t slotIdx, SlotItem &item)
     {
         // Reset name to default
-        snprintf(item.name, sizeof(item.name), "Slot %02d     ", slotIdx + 1);
+        char name[nameLengthMax + 1];
+        snprintf_P(name, sizeof(name), PSTR("Slot %-7.2u"), slotIdx + 1);
+        packName(name, item.name);
 
         // Invalidate the signal
-        item.signal = signalInvalid;
+        packSignal(signalInvalid, item.signal);
 
 #ifdef LOG_DEBUG
-        Log::printf("Reset slot[%u]", slotIdx);
+        Log::printf(F("Reset slot[%u]"), slotIdx);
 #endif // LOG_DEBUG
-
-        // Save to the storage
-        save(slotIdx, item);
     }
 
     /**
      * @brief Load slot item from the storage
+     * Invalid slot item is reset to default values
      *
      * @param slotIdx Slot identifier
      * @param item Slot item to load
      */
     void load(uint8_t slotIdx, SlotItem &item)
     {
-        int slotAddress = slotIdx * slotStorageSize;
-        int crc8Address = slotAddress + sizeof(SlotItem);
-        uint8_t crc8 = 0;
-
-        EEPROM.get(slotAddress, item);
-        EEPROM.get(crc8Address, crc8);
-
-        uint8_t calcCrc8 = calcCRC8((const uint8_t *)&item, sizeof(item));
-        if (calcCrc8 != crc8)
+        if (Journal::read(slotIdx, &item) == false)
         {
-            // Reset slot if it isn't valid
+            // Reset slot if it was never saved, it is saved on the first change
             reset(slotIdx, item);
         }
 
 #ifdef LOG_DEBUG
-        Log::printf("Load slot[%u]: \"%s\" %02u 0x%02lX/%u", slotIdx, item.name,
+        char name[nameLengthMax + 1];
+        unpackName(item.name, name);
+        Log::printf(F("Load slot[%u]: \"%s\" %02u 0x%02lX/%u"), slotIdx, name,
                     item.signal.protocol, item.signal.value, item.signal.bitLength);
 #endif // LOG_DEBUG
     }
+
+    /**
+     * @brief Load slot item from the fixed-address layout of firmware v0.5
+     *
+     * @param slotIdx Slot identifier
+     * @param item Slot item to load
+     * @return true if slot item is valid, false otherwise
+     */
+    bool loadLegacy(uint8_t slotIdx, SlotItem &item)
+    {
+        int slotAddress = slotIdx * legacySlotStorageSize;
+        int crc8Address = slotAddress + sizeof(LegacySlotItem);
+        LegacySlotItem legacyItem;
+        uint8_t crc8 = 0;
+
+        Storage::get(slotAddress, legacyItem);
+        Storage::get(crc8Address, crc8);
+        bool isValid = (Crc8::calculate(&legacyItem, sizeof(legacyItem)) == crc8);
+
+        // Name was stored with the end of line
+        legacyItem.name[nameLengthMax] = '\0';
+        packName(legacyItem.name, item.name);
+        item.signal = legacyItem.signal;
+
+        return isValid;
+    }
+
+    /**
+     * @brief Find cached slot item
+     *
+     * @param slotIdx Slot identifier
+     * @return Cached slot item entry, nullptr if slot is not cached
+     */
+    CacheEntry *findCacheEntry(uint8_t slotIdx)
+    {
+        for (CacheEntry &entry : cache)
+        {
+            if (entry.state != CacheState::Empty && entry.slotIdx == slotIdx)
+            {
+                return &entry;
+            }
+        }
+
+        return nullptr;
+    }
+
+    /**
+     * @brief Return cached slot item, load it from the storage if it is not cached
+     * Entries are replaced in round-robin order, modified item is saved before replacement
+     *
+     * @param slotIdx Slot identifier (should be valid)
+     * @return Cached slot item entry
+     */
+    CacheEntry &getCacheEntry(uint8_t slotIdx)
+    {
+        CacheEntry *pEntry = findCacheEntry(slotIdx);
+        if (pEntry != nullptr)
+        {
+            return *pEntry;
+        }
+
+        CacheEntry &entry = cache[cacheReplaceIdx];
+        cacheReplaceIdx = (cacheReplaceIdx + 1) % cacheSize;
+
+        if (entry.state == CacheState::Dirty)
+        {
+            save(entry.slotIdx, entry.item);
+        }
+        load(slotIdx, entry.item);
+        entry.slotIdx = slotIdx;
+        entry.state = CacheState::Clean;
+
+        return entry;
+    }
+
+    /**
+     * @brief Build signal index of all slots
+     * Slots are read bypassing the cache to keep recently used items cached
+     */
+    void buildSignalIndex()
+    {
+        for (uint8_t slotIdx = 0; slotIdx < slotsCount; slotIdx++)
+        {
+            const CacheEntry *pEntry = findCacheEntry(slotIdx);
+            if (pEntry != nullptr)
+            {
+                updateSignalIndex(slotIdx, pEntry->item.signal);
+            }
+            else
+            {
+                SlotItem item;
+                load(slotIdx, item);
+                updateSignalIndex(slotIdx, item.signal);
+            }
+        }
+
+        isSignalIndexBuilt = true;
+    }
+
+    /**
+     * @brief Move slots saved by the fixed-address layout to the journal
+     * Journal overwrites the layout, so all valid slots are read first
+     */
+    void migrateLegacy()
+    {
+        SlotItem items[legacySlotsCount];
+        uint16_t validMask = 0;
+
+        for (uint8_t slotIdx = 0; slotIdx < legacySlotsCount; slotIdx++)
+        {
+            if (loadLegacy(slotIdx, items[slotIdx]) == true)
+            {
+                validMask |= (1U << slotIdx);
+            }
+        }
+
+        Journal::format();
+
+        for (uint8_t slotIdx = 0; slotIdx < legacySlotsCount; slotIdx++)
+        {
+            if ((validMask & (1U << slotIdx)) != 0)
+            {
+                save(slotIdx, items[slotIdx]);
+            }
+        }
+    }
 } // namespace
 
+/**
+ * @brief Return index of the name character
+ *
+ * @param ch Name character
+ * @return Index in nameChars, index of space for not allowed character
+ */
+uint8_t Slot::getNameCharIdx(char ch)
+{
+    uint8_t charIdx = 0;
+
+    if (ch >= '0' && ch <= '9')
+    {
+        charIdx = 1 + (ch - '0');
+    }
+    else if (ch >= 'A' && ch <= 'Z')
+    {
+        charIdx = 11 + (ch - 'A');
+    }
+    else if (ch >= 'a' && ch <= 'z')
+    {
+        charIdx = 37 + (ch - 'a');
+    }
+
+    return charIdx;
+}
+
+/**
+ * @brief Return name character by its index
+ * Characters are computed, so the set is not kept in RAM
+ *
+ * @param charIdx Index in nameChars
+ * @return Name character, space for the index out of the set
+ */
+char Slot::getNameChar(uint8_t charIdx)
+{
+    if (charIdx >= 37 && charIdx < nameCharsCount)
+    {
+        return 'a' + (charIdx - 37);
+    }
+    else if (charIdx >= 11 && charIdx < 37)
+    {
+        return 'A' + (charIdx - 11);
+    }
+    else if (charIdx >= 1 && charIdx < 11)
+    {
+        return '0' + (charIdx - 1);
+    }
+
+    return ' ';
+}
+
+/**
+ * @brief Pack name to 6 bits per character
+ * Name is padded with spaces to nameLengthMax characters
+ *
+ * @param name Name to pack (null-terminated string)
+ * @param packedName Buffer for packed name (packedNameSize bytes)
+ */
+void Slot::packName(const char *name, uint8_t *packedName)
+{
+    uint16_t bits = 0;
+    uint8_t bitsCount = 0;
+    bool isEnd = false;
+
+    for (uint8_t charOffset = 0; charOffset < nameLengthMax; charOffset++)
+    {
+        if (name[charOffset] == '\0')
+        {
+            isEnd = true;
+        }
+
+        bits = (bits << 6) | getNameCharIdx(isEnd ? ' ' : name[charOffset]);
+        bitsCount += 6;
+        if (bitsCount >= 8)
+        {
+            // Output complete byte, most significant bits first
+            bitsCount -= 8;
+            *packedName++ = bits >> bitsCount;
+        }
+    }
+
+    if (bitsCount > 0)
+    {
+        // Output the rest bits
+        *packedName = bits << (8 - bitsCount);
+    }
+}
+
+/**
+ * @brief Unpack name packed by packName()
+ *
+ * @param packedName Packed name (packedNameSize bytes)
+ * @param name Buffer for name (at least nameLengthMax + 1 size)
+ */
+void Slot::unpackName(const uint8_t *packedName, char *name)
+{
+    uint16_t bits = 0;
+    uint8_t bitsCount = 0;
+
+    for (uint8_t charOffset = 0; charOffset < nameLengthMax; charOffset++)
+    {
+        if (bitsCount < 6)
+        {
+            // Input next byte
+            bits = (bits << 8) | *packedName++;
+            bitsCount += 8;
+        }
+
+        bitsCount -= 6;
+        uint8_t charIdx = (bits >> bitsCount) & 0x3F;
+        name[charOffset] = getNameChar(charIdx);
+    }
+
+    name[nameLengthMax] = '\0';
+}
+
+/**
+ * @brief Initialize slots storage
+ */
+void Slot::initialize()
+{
+    Storage::initialize();
+
+    if (Journal::initialize() == false)
+    {
+        if (Storage::isEeprom == true)
+        {
+            // Keep slots saved by the fixed-address layout
+            migrateLegacy();
+        }
+        else
+        {
+            Journal::format();
+        }
+    }
+}
+
 /**
  * @brief Return signal from specified slot
  *
@@ -111,12 +560,8 @@ void Slot::getSignal(uint8_t slotIdx, Signal &signal)
 {
     if (slotIdx < slotsCount)
     {
-        // Load current slot item
-        SlotItem item;
-        load(slotIdx, item);
-
-        // Copy slot signal
-        signal = item.signal;
+        // Copy cached slot signal
+        unpackSignal(getCacheEntry(slotIdx).item.signal, signal);
     }
     else
     {
@@ -127,6 +572,7 @@ void Slot::getSignal(uint8_t slotIdx, Signal &signal)
 
 /**
  * @brief Set signal to specified slot
+ * Change is kept in RAM until flush() is called
  *
  * @param slotIdx Slot identifier
  * @param signal New slot signal
@@ -135,13 +581,16 @@ void Slot::setSignal(uint8_t slotIdx, const Signal &signal)
 {
     if (slotIdx < slotsCount)
     {
-        // Load current slot item
-        SlotItem item;
-        load(slotIdx, item);
-
-        // Copy new signal and save updated item
-        item.signal = signal;
-        save(slotIdx, item);
+        CacheEntry &entry = getCacheEntry(slotIdx);
+        PackedSignal packed;
+        packSignal(signal, packed);
+        if (memcmp(&entry.item.signal, &packed, sizeof(packed)) != 0)
+        {
+            // Copy new signal and mark item to be saved
+            entry.item.signal = packed;
+            entry.state = CacheState::Dirty;
+            updateSignalIndex(slotIdx, signal);
+        }
     }
 }
 
@@ -155,24 +604,19 @@ void Slot::getName(uint8_t slotIdx, char *name)
 {
     if (slotIdx < slotsCount)
     {
-        // Load current slot item
-        SlotItem item;
-        load(slotIdx, item);
-
-        // Copy slot name
-        snprintf(name, sizeof(item.name), "%s", item.name);
+        // Unpack cached slot name
+        unpackName(getCacheEntry(slotIdx).item.name, name);
     }
     else
     {
         // Set empty name
         name[0] = '\0';
     }
-
-    return name;
 }
 
 /**
  * @brief Set new slot name
+ * Change is kept in RAM until flush() is called
  *
  * @param slotIdx Slot identifier
  * @param name New slot name (null-terminated string)
@@ -181,25 +625,341 @@ void Slot::setName(uint8_t slotIdx, const char *name)
 {
     if (slotIdx < slotsCount)
     {
-        // Load current slot item
-        SlotItem item;
-        load(slotIdx, item);
+        uint8_t packedName[packedNameSize];
+        packName(name, packedName);
+
+        CacheEntry &entry = getCacheEntry(slotIdx);
+        if (memcmp(entry.item.name, packedName, packedNameSize) != 0)
+        {
+            // Copy new name and mark item to be saved
+            memcpy(entry.item.name, packedName, packedNameSize);
+            entry.state = CacheState::Dirty;
+        }
+    }
+}
 
-        // Copy new name and save updated item
-        snprintf(item.name, sizeof(item.name), "%s", name);
-        save(slotIdx, item);
+/**
+ * @brief Begin slot update transaction
+ * Slot changes are collected until commit() is called
+ *
+ * @param slotIdx Slot identifier
+ */
+void Slot::begin(uint8_t slotIdx)
+{
+    if (slotIdx < slotsCount)
+    {
+        // Start from the current slot item
+        transaction.item = getCacheEntry(slotIdx).item;
+        transaction.slotIdx = slotIdx;
+    }
+    else
+    {
+        transaction.slotIdx = invalidIdx;
+    }
+}
+
+/**
+ * @brief Modify slot name in the current transaction
+ *
+ * @param name New slot name (null-terminated string)
+ */
+void Slot::modifyName(const char *name)
+{
+    if (transaction.slotIdx < slotsCount)
+    {
+        packName(name, transaction.item.name);
+    }
+}
+
+/**
+ * @brief Modify slot signal in the current transaction
+ *
+ * @param signal New slot signal
+ */
+void Slot::modifySignal(const Signal &signal)
+{
+    if (transaction.slotIdx < slotsCount)
+    {
+        packSignal(signal, transaction.item.signal);
+    }
+}
+
+/**
+ * @brief Commit current transaction as a single storage record
+ * Nothing is written if the slot is not changed
+ *
+ * @return true if changes are saved, false if nothing to save
+ */
+bool Slot::commit()
+{
+    bool result = false;
+
+    if (transaction.slotIdx < slotsCount)
+    {
+        CacheEntry &entry = getCacheEntry(transaction.slotIdx);
+        if (entry.state == CacheState::Dirty ||
+            memcmp(&entry.item, &transaction.item, sizeof(SlotItem)) != 0)
+        {
+            // All changed fields go to one record with one CRC
+            entry.item = transaction.item;
+            save(transaction.slotIdx, entry.item);
+            entry.state = CacheState::Clean;
+            updateSignalIndex(transaction.slotIdx, entry.item.signal);
+            result = true;
+        }
+
+        transaction.slotIdx = invalidIdx;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Check if there are slot changes not saved on the storage
+ *
+ * @return true if any slot is modified, false otherwise
+ */
+bool Slot::isDirty()
+{
+    bool isDirty = false;
+
+    for (const CacheEntry &entry : cache)
+    {
+        if (entry.state == CacheState::Dirty)
+        {
+            isDirty = true;
+            break;
+        }
+    }
+
+    return isDirty;
+}
+
+/**
+ * @brief Save all modified slots to the storage
+ * Returns immediately, writing is done in background (see isPending())
+ */
+void Slot::flush()
+{
+    for (CacheEntry &entry : cache)
+    {
+        if (entry.state == CacheState::Dirty)
+        {
+            save(entry.slotIdx, entry.item);
+            entry.state = CacheState::Clean;
+        }
     }
 }
 
+/**
+ * @brief Check if saved slot changes are still being written to the storage
+ *
+ * @return true if writing is in progress, false if all changes are committed
+ */
+bool Slot::isPending()
+{
+    return Storage::isPending();
+}
+
 /**
  * @brief Erase all slots on the storage
  */
 void Slot::eraseStorage()
 {
-    const int storageSize = slotsCount * slotStorageSize;
-    for (int idx = 0; idx < storageSize; idx++)
+    Journal::format();
+
+    for (CacheEntry &entry : cache)
     {
-        // Erase storage with 0xFF
-        EEPROM.write(idx, 0xFF);
+        // Reload slots from the erased storage
+        entry.state = CacheState::Empty;
     }
-}
\ No newline at end of file
+
+    // No signals are stored
+    memset(signalIndex, 0, sizeof(signalIndex));
+    isSignalIndexBuilt = true;
+}
+
+/**
+ * @brief Find slot with the signal
+ * Slot signals are indexed on the first call, then lookup doesn't read the storage
+ * except for the matching slot
+ *
+ * @param signal Signal to find
+ * @return Identifier of the first slot with the signal, invalidIdx if not found
+ */
+uint8_t Slot::findSignal(const Signal &signal)
+{
+    uint8_t fingerprint = getFingerprint(signal);
+    if (fingerprint == 0)
+    {
+        return invalidIdx;
+    }
+
+    if (isSignalIndexBuilt == false)
+    {
+        buildSignalIndex();
+    }
+
+    for (uint8_t slotIdx = 0; slotIdx < slotsCount; slotIdx++)
+    {
+        if (signalIndex[slotIdx] == fingerprint)
+        {
+            // Fingerprints may collide, compare the signal itself
+            Signal slotSignal;
+            getSignal(slotIdx, slotSignal);
+            if (slotSignal == signal)
+            {
+                return slotIdx;
+            }
+        }
+    }
+
+    return invalidIdx;
+}
+
+/**
+ * @brief Save raw frame for the slot
+ * Frame is written to the storage right away, slot refers to it when the returned signal
+ * is set to the slot. Frame of the slot is replaced only if no other storage is free.
+ *
+ * @param slotIdx Slot identifier
+ * @param frame Packed frame
+ * @param size Packed frame size, bytes (up to rawFrameSizeMax)
+ * @param signal Object to store the signal referring to the frame
+ * @return true if frame is saved, false if no raw frame storage is free
+ */
+bool Slot::saveRawFrame(uint8_t slotIdx, const uint8_t *frame, uint8_t size, Signal &signal)
+{
+    if (slotIdx >= slotsCount || size == 0 || size > rawFrameSizeMax)
+    {
+        return false;
+    }
+
+    Signal slotSignal;
+    getSignal(slotIdx, slotSignal);
+
+    // Frame is free if its owner slot doesn't refer to it
+    uint8_t record[Journal::dataSize];
+    uint8_t frameIdx = 0;
+    for (; frameIdx < rawFramesCount; frameIdx++)
+    {
+        if (Journal::read(getRawFrameKey(frameIdx, 0), record) == false || record[0] >= slotsCount)
+        {
+            break;
+        }
+
+        Signal ownerSignal;
+        getSignal(record[0], ownerSignal);
+        if (isRaw(ownerSignal) == false || ownerSignal.value != frameIdx)
+        {
+            break;
+        }
+    }
+
+    if (frameIdx == rawFramesCount)
+    {
+        if (isRaw(slotSignal) == false || slotSignal.value >= rawFramesCount)
+        {
+            return false;
+        }
+        frameIdx = slotSignal.value;
+    }
+
+    // The first record keeps the owner slot
+    uint8_t recordIdx = 0;
+    uint8_t frameOffset = 0;
+    while (frameOffset < size)
+    {
+        uint8_t dataOffset = (recordIdx == 0) ? 1 : 0;
+        uint8_t length = Journal::dataSize - dataOffset;
+        if (length > size - frameOffset)
+        {
+            length = size - frameOffset;
+        }
+
+        memset(record, 0, sizeof(record));
+        record[0] = slotIdx;
+        memcpy(&record[dataOffset], &frame[frameOffset], length);
+        Journal::write(getRawFrameKey(frameIdx, recordIdx), record);
+
+        frameOffset += length;
+        recordIdx++;
+    }
+
+#ifdef LOG_DEBUG
+    Log::printf(F("Save raw frame[%u]: slot %u, %u bytes"), frameIdx, slotIdx, size);
+#endif // LOG_DEBUG
+
+    signal = {frameIdx, rawProtocol, size};
+    return true;
+}
+
+/**
+ * @brief Load raw frame the signal refers to
+ *
+ * @param signal Raw frame signal
+ * @param frame Buffer for packed frame (rawFrameSizeMax bytes)
+ * @return true if frame is loaded, false otherwise
+ */
+bool Slot::loadRawFrame(const Signal &signal, uint8_t *frame)
+{
+    if (isRaw(signal) == false || signal.value >= rawFramesCount ||
+        signal.bitLength == 0 || signal.bitLength > rawFrameSizeMax)
+    {
+        return false;
+    }
+
+    uint8_t record[Journal::dataSize];
+    uint8_t recordIdx = 0;
+    uint8_t frameOffset = 0;
+    while (frameOffset < signal.bitLength)
+    {
+        if (Journal::read(getRawFrameKey(signal.value, recordIdx), record) == false)
+        {
+            return false;
+        }
+
+        uint8_t dataOffset = (recordIdx == 0) ? 1 : 0;
+        uint8_t length = Journal::dataSize - dataOffset;
+        if (length > signal.bitLength - frameOffset)
+        {
+            length = signal.bitLength - frameOffset;
+        }
+        memcpy(&frame[frameOffset], &record[dataOffset], length);
+
+        frameOffset += length;
+        recordIdx++;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Return device settings
+ *
+ * @param settings Object to copy the settings, defaults if nothing is saved
+ */
+void Slot::getSettings(Settings &settings)
+{
+    uint8_t record[Journal::dataSize];
+    if (Journal::read(settingsKey, record) == false)
+    {
+        settings = settingsDefault;
+        return;
+    }
+
+    memcpy(&settings, record, sizeof(settings));
+}
+
+/**
+ * @brief Save device settings
+ * Settings are written to the storage right away
+ *
+ * @param settings New settings
+ */
+void Slot::setSettings(const Settings &settings)
+{
+    uint8_t record[Journal::dataSize] = {};
+    memcpy(record, &settings, sizeof(settings));
+    Journal::write(settingsKey, record);
+}
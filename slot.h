@@ -2,13 +2,30 @@
 
 #include <stdint.h>
 
+#include "journal.h"
+
 namespace Slot
 {
-    // Number of slot items
-    static constexpr uint8_t slotsCount = 10;
+    // Raw frames kept for the slots, each one takes several journal records after the slot ones
+    static constexpr uint8_t rawFramesCount = Storage::isEeprom ? 1 : 8;
+    static constexpr uint8_t rawFrameRecords = 3;
+    // Maximum raw frame size, bytes (record of the frame also keeps its owner slot)
+    static constexpr uint8_t rawFrameSizeMax = rawFrameRecords * Journal::dataSize - 1;
+    // Protocol number of the signal referring to a raw frame,
+    // value of such signal is the raw frame index and bit length is the frame size
+    static constexpr uint8_t rawProtocol = 0xFF;
+    // Device settings take the journal record after the raw frame ones
+    static constexpr uint8_t settingsRecords = 1;
+    // Number of slot items, depends on the storage capacity
+    static constexpr uint8_t slotsCount = Journal::keysCount - rawFramesCount * rawFrameRecords - settingsRecords;
     static constexpr uint8_t invalidIdx = slotsCount;
     // Maximum name length
     static constexpr uint8_t nameLengthMax = 12;
+    // Characters allowed in names, stored as 6-bit indexes in this set
+    static constexpr char nameChars[] = " 0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+    static constexpr uint8_t nameCharsCount = sizeof(nameChars) - 1;
+    // Packed name size, bytes
+    static constexpr uint8_t packedNameSize = (nameLengthMax * 6 + 7) / 8;
 
 #pragma pack(push, 1)
     /**
@@ -19,7 +36,10 @@ namespace Slot
         uint32_t value;
         uint8_t protocol;
         uint8_t bitLength;
+        // Pulse length measured by the receiver, microseconds, 0 for the protocol one
+        uint16_t pulseLengthUs;
 
+        // Frames of the same signal differ in the measured pulse length, it is not compared
         bool operator==(const Signal &other) const
         {
             return ((protocol == other.protocol) &&
@@ -29,7 +49,70 @@ namespace Slot
     };
 #pragma pack(pop)
 
-    static constexpr Signal signalInvalid = {0, 0, 0};
+    static constexpr Signal signalInvalid = {0, 0, 0, 0};
+
+#pragma pack(push, 1)
+    /**
+     * @brief Device settings kept next to the slots
+     */
+    struct Settings
+    {
+        // Protocols tried by the receiver, bit 0 is protocol 1
+        uint16_t protocolMask;
+    };
+#pragma pack(pop)
+
+    static constexpr Settings settingsDefault = {0xFFFF};
+
+    /**
+     * @brief Check if signal refers to a raw frame
+     *
+     * @param signal Slot signal
+     * @return true for raw frame signal, false for decoded one
+     */
+    inline bool isRaw(const Signal &signal)
+    {
+        return signal.protocol == rawProtocol;
+    }
+
+    /**
+     * @brief Return index of the name character
+     *
+     * @param ch Name character
+     * @return Index in nameChars, index of space for not allowed character
+     */
+    uint8_t getNameCharIdx(char ch);
+
+    /**
+     * @brief Return name character by its index
+     * Characters are computed, so the set is not kept in RAM
+     *
+     * @param charIdx Index in nameChars
+     * @return Name character, space for the index out of the set
+     */
+    char getNameChar(uint8_t charIdx);
+
+    /**
+     * @brief Pack name to 6 bits per character
+     * Name is padded with spaces to nameLengthMax characters
+     *
+     * @param name Name to pack (null-terminated string)
+     * @param packedName Buffer for packed name (packedNameSize bytes)
+     */
+    void packName(const char *name, uint8_t *packedName);
+
+    /**
+     * @brief Unpack name packed by packName()
+     *
+     * @param packedName Packed name (packedNameSize bytes)
+     * @param name Buffer for name (at least nameLengthMax + 1 size)
+     */
+    void unpackName(const uint8_t *packedName, char *name);
+
+    /**
+     * @brief Initialize slots storage
+     */
+    void initialize();
 
     /**
      * @brief Return signal from specified slot
@@ -41,6 +124,7 @@ namespace Slot
 
     /**
      * @brief Set signal to specified slot
+     * Change is kept in RAM until flush() is called
      *
      * @param slotIdx Slot identifier
      * @param signal New slot signal
@@ -57,14 +141,112 @@ namespace Slot
 
     /**
      * @brief Set slot name
+     * Change is kept in RAM until flush() is called
      *
      * @param slotIdx Slot identifier
      * @param name New slot name (null-terminated string)
      */
     void setName(uint8_t slotIdx, const char *name);
 
+    /**
+     * @brief Begin slot update transaction
+     * Slot changes are collected until commit() is called
+     *
+     * @param slotIdx Slot identifier
+     */
+    void begin(uint8_t slotIdx);
+
+    /**
+     * @brief Modify slot name in the current transaction
+     *
+     * @param name New slot name (null-terminated string)
+     */
+    void modifyName(const char *name);
+
+    /**
+     * @brief Modify slot signal in the current transaction
+     *
+     * @param signal New slot signal
+     */
+    void modifySignal(const Signal &signal);
+
+    /**
+     * @brief Commit current transaction as a single storage record
+     * Nothing is written if the slot is not changed
+     *
+     * @return true if changes are saved, false if nothing to save
+     */
+    bool commit();
+
+    /**
+     * @brief Check if there are slot changes not saved on the storage
+     *
+     * @return true if any slot is modified, false otherwise
+     */
+    bool isDirty();
+
+    /**
+     * @brief Save all modified slots to the storage
+     * Returns immediately, writing is done in background (see isPending())
+     */
+    void flush();
+
+    /**
+     * @brief Check if saved slot changes are still being written to the storage
+     *
+     * @return true if writing is in progress, false if all changes are committed
+     */
+    bool isPending();
+
     /**
      * @brief Erase all slots on the storage
      */
     void eraseStorage();
+
+    /**
+     * @brief Find slot with the signal
+     * Slot signals are indexed on the first call, then lookup doesn't read the storage
+     * except for the matching slot
+     *
+     * @param signal Signal to find
+     * @return Identifier of the first slot with the signal, invalidIdx if not found
+     */
+    uint8_t findSignal(const Signal &signal);
+
+    /**
+     * @brief Save raw frame for the slot
+     * Frame is written to the storage right away, slot refers to it when the returned signal
+     * is set to the slot. Frame of the slot is replaced only if no other storage is free.
+     *
+     * @param slotIdx Slot identifier
+     * @param frame Packed frame
+     * @param size Packed frame size, bytes (up to rawFrameSizeMax)
+     * @param signal Object to store the signal referring to the frame
+     * @return true if frame is saved, false if no raw frame storage is free
+     */
+    bool saveRawFrame(uint8_t slotIdx, const uint8_t *frame, uint8_t size, Signal &signal);
+
+    /**
+     * @brief Load raw frame the signal refers to
+     *
+     * @param signal Raw frame signal
+     * @param frame Buffer for packed frame (rawFrameSizeMax bytes)
+     * @return true if frame is loaded, false otherwise
+     */
+    bool loadRawFrame(const Signal &signal, uint8_t *frame);
+
+    /**
+     * @brief Return device settings
+     *
+     * @param settings Object to copy the settings, defaults if nothing is saved
+     */
+    void getSettings(Settings &settings);
+
+    /**
+     * @brief Save device settings
+     * Settings are written to the storage right away
+     *
+     * @param settings New settings
+     */
+    void setSettings(const Settings &settings);
 } // namespace Slot
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// #define STORAGE_SPI_FRAM // Uncomment to keep slots on the external SPI FRAM instead of the EEPROM
+
+/**
+ * Paged non-volatile storage
+ *
+ * Storage is implemented by one of the backends selected at build time:
+ * - storage_eeprom.cpp: internal EEPROM, writes are queued and committed from the EEPROM ready
+ *   interrupt, reads return queued data which is not committed yet
+ * - storage_fram.cpp: external SPI FRAM (STORAGE_SPI_FRAM), writes are completed immediately
+ * - sim/storage_file.cpp: file on the host (STORAGE_FILE), stand-in for the external memory in
+ *   the simulator
+ *
+ * Storage is split into pages of the same size, data which should be written as a whole
+ * is expected to be placed within one page.
+ */
+namespace Storage
+{
+#if defined(STORAGE_SPI_FRAM)
+    // MB85RS256B, 32 KB without pages
+    static constexpr uint32_t size = 32768;
+    static constexpr uint16_t pageSize = 32768;
+    static constexpr bool isEeprom = false;
+#elif defined(STORAGE_FILE)
+    // Same capacity as FRAM with flash-like pages
+    static constexpr uint32_t size = 32768;
+    static constexpr uint16_t pageSize = 256;
+    static constexpr bool isEeprom = false;
+#else
+#define STORAGE_EEPROM
+    // ATmega328P EEPROM, one page
+    static constexpr uint32_t size = 1024;
+    static constexpr uint16_t pageSize = 1024;
+    static constexpr bool isEeprom = true;
+#endif
+
+    static constexpr uint16_t pagesCount = size / pageSize;
+
+    /**
+     * @brief Initialize storage
+     */
+    void initialize();
+
+    /**
+     * @brief Read data from the storage
+     *
+     * @param address Data start address
+     * @param data Buffer for data
+     * @param length Data length, bytes
+     */
+    void read(uint32_t address, void *data, uint16_t length);
+
+    /**
+     * @brief Write data to the storage
+     * Write may be completed in background (see isPending())
+     *
+     * @param address Data start address
+     * @param data Data to write
+     * @param length Data length, bytes
+     */
+    void write(uint32_t address, const void *data, uint16_t length);
+
+    /**
+     * @brief Fill storage range with the same value
+     * Fill may be completed in background (see isPending())
+     *
+     * @param address Range start address
+     * @param value Byte value to fill
+     * @param length Range length, bytes
+     */
+    void fill(uint32_t address, uint8_t value, uint16_t length);
+
+    /**
+     * @brief Check if there are writes not committed to the storage yet
+     *
+     * @return true if writes are pending, false if all writes are committed
+     */
+    bool isPending();
+
+    /**
+     * @brief Wait until all writes are committed
+     */
+    void flush();
+
+    /**
+     * @brief Return start address of the page
+     *
+     * @param pageIdx Page index
+     * @return Page start address
+     */
+    inline uint32_t getPageAddress(uint16_t pageIdx)
+    {
+        return (uint32_t)pageIdx * pageSize;
+    }
+
+    /**
+     * @brief Read object from the storage
+     *
+     * @param address Object start address
+     * @param object Object to read
+     */
+    template <typename T>
+    void get(uint32_t address, T &object)
+    {
+        read(address, &object, sizeof(T));
+    }
+
+    /**
+     * @brief Write object to the storage
+     *
+     * @param address Object start address
+     * @param object Object to write
+     */
+    template <typename T>
+    void put(uint32_t address, const T &object)
+    {
+        write(address, &object, sizeof(T));
+    }
+} // namespace Storage
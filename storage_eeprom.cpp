@@ -0,0 +1,272 @@
+#include "storage.h"
+
+#ifdef STORAGE_EEPROM
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "hal.h"
+
+using namespace Storage;
+
+namespace
+{
+    static_assert(Storage::size == Hal::Eeprom::size);
+
+    // Write queue capacity
+    constexpr uint8_t spansMax = 8;
+    constexpr uint8_t dataCapacity = 64;
+    // Unchanged bytes skipped per interrupt to keep it short
+    constexpr uint8_t skipsPerInterruptMax = 16;
+    // Polling period while waiting for the queue, microseconds
+    constexpr uint16_t waitPeriodUs = 100;
+
+    /**
+     * @brief Queued write range structure
+     */
+    struct Span
+    {
+        uint16_t address;
+        uint16_t length;
+        bool isFill;
+        uint8_t fillValue;
+        uint8_t dataIdx; // start of the span data in the data ring
+    };
+
+    // Queued spans ring, oldest one is being committed
+    Span spans[spansMax];
+    volatile uint8_t spanTail = 0;
+    volatile uint8_t spanCount = 0;
+    // Bytes of the oldest span already processed
+    volatile uint16_t spanProgress = 0;
+
+    // Queued span data ring
+    uint8_t data[dataCapacity];
+    uint8_t dataHead = 0;
+    volatile uint8_t dataCount = 0;
+
+    /**
+     * @brief Return queued byte value of the span
+     *
+     * @param span Queued span
+     * @param offset Byte offset in the span
+     * @return Byte value
+     */
+    inline uint8_t getSpanValue(const Span &span, uint16_t offset)
+    {
+        return span.isFill ? span.fillValue : data[(span.dataIdx + offset) % dataCapacity];
+    }
+
+    /**
+     * @brief EEPROM ready interrupt handler, commits queued bytes one by one
+     */
+    void onEepromReady()
+    {
+        uint8_t skipCount = 0;
+
+        while (spanCount > 0)
+        {
+            const Span &span = spans[spanTail];
+            if (spanProgress < span.length)
+            {
+                int address = span.address + spanProgress;
+                uint8_t value = getSpanValue(span, spanProgress);
+                spanProgress++;
+
+                if (Hal::Eeprom::read(address) != value)
+                {
+                    // Interrupt fires again when the byte is written
+                    Hal::Eeprom::startWrite(address, value);
+                    return;
+                }
+
+                if (++skipCount >= skipsPerInterruptMax)
+                {
+                    // Interrupt fires again right away
+                    return;
+                }
+            }
+            else
+            {
+                // Span is committed, release it
+                if (span.isFill == false)
+                {
+                    dataCount -= span.length;
+                }
+                spanTail = (spanTail + 1) % spansMax;
+                spanCount--;
+                spanProgress = 0;
+            }
+        }
+
+        // Nothing left to write
+        Hal::Eeprom::enableReadyInterrupt(false);
+    }
+
+    /**
+     * @brief Wait until the queue has space for the new span
+     *
+     * @param length Span data length, bytes
+     */
+    void waitForSpace(uint8_t length)
+    {
+        while (spanCount >= spansMax || dataCount + length > dataCapacity)
+        {
+            Hal::Clock::delayMicroseconds(waitPeriodUs);
+        }
+    }
+
+    /**
+     * @brief Add span to the queue and start committing
+     *
+     * @param span Span to add
+     */
+    void enqueue(const Span &span)
+    {
+        uint8_t state = Hal::Interrupts::lock();
+
+        spans[(spanTail + spanCount) % spansMax] = span;
+        spanCount++;
+        if (span.isFill == false)
+        {
+            dataCount += span.length;
+        }
+
+        Hal::Interrupts::restore(state);
+
+        Hal::Eeprom::enableReadyInterrupt(true);
+    }
+
+    /**
+     * @brief Read byte from the EEPROM
+     *
+     * @param address Byte address
+     * @return Byte value, including queued writes
+     */
+    uint8_t readByte(uint16_t address)
+    {
+        while (true)
+        {
+            uint8_t state = Hal::Interrupts::lock();
+
+            // The newest queued value wins
+            for (uint8_t idx = spanCount; idx > 0; idx--)
+            {
+                const Span &span = spans[(spanTail + idx - 1) % spansMax];
+                if (address >= span.address && address < span.address + span.length)
+                {
+                    uint8_t value = getSpanValue(span, address - span.address);
+                    Hal::Interrupts::restore(state);
+                    return value;
+                }
+            }
+
+            if (Hal::Eeprom::isReady() == true)
+            {
+                // Interrupt can't start a write while reading
+                uint8_t value = Hal::Eeprom::read(address);
+                Hal::Interrupts::restore(state);
+                return value;
+            }
+
+            Hal::Interrupts::restore(state);
+        }
+    }
+} // namespace
+
+/**
+ * @brief Initialize storage
+ */
+void Storage::initialize()
+{
+    Hal::Eeprom::setReadyHandler(onEepromReady);
+}
+
+/**
+ * @brief Read data from the storage
+ *
+ * @param address Data start address
+ * @param data Buffer for data
+ * @param length Data length, bytes
+ */
+void Storage::read(uint32_t address, void *data, uint16_t length)
+{
+    uint8_t *pData = (uint8_t *)data;
+    for (uint16_t idx = 0; idx < length; idx++)
+    {
+        pData[idx] = readByte(address + idx);
+    }
+}
+
+/**
+ * @brief Write data to the storage
+ * Write is queued and completed in background, waits only if the write queue is full.
+ * Bytes which already hold the value are not written.
+ *
+ * @param address Data start address
+ * @param data Data to write
+ * @param length Data length, bytes
+ */
+void Storage::write(uint32_t address, const void *data, uint16_t length)
+{
+    const uint8_t *pData = (const uint8_t *)data;
+
+    while (length > 0)
+    {
+        uint8_t chunkLength = (length < dataCapacity) ? length : dataCapacity;
+        waitForSpace(chunkLength);
+
+        Span span = {(uint16_t)address, chunkLength, false, 0, dataHead};
+        for (uint8_t idx = 0; idx < chunkLength; idx++)
+        {
+            // Free part of the ring isn't touched by the interrupt
+            ::data[dataHead] = pData[idx];
+            dataHead = (dataHead + 1) % dataCapacity;
+        }
+        enqueue(span);
+
+        address += chunkLength;
+        pData += chunkLength;
+        length -= chunkLength;
+    }
+}
+
+/**
+ * @brief Fill storage range with the same value
+ * Fill is queued and completed in background
+ *
+ * @param address Range start address
+ * @param value Byte value to fill
+ * @param length Range length, bytes
+ */
+void Storage::fill(uint32_t address, uint8_t value, uint16_t length)
+{
+    waitForSpace(0);
+
+    Span span = {(uint16_t)address, length, true, value, 0};
+    enqueue(span);
+}
+
+/**
+ * @brief Check if there are writes not committed to the storage yet
+ *
+ * @return true if writes are pending, false if all writes are committed
+ */
+bool Storage::isPending()
+{
+    return spanCount > 0;
+}
+
+/**
+ * @brief Wait until all writes are committed
+ */
+void Storage::flush()
+{
+    while (isPending() == true)
+    {
+        Hal::Clock::delayMicroseconds(waitPeriodUs);
+    }
+}
+
+#endif // STORAGE_EEPROM
@@ -0,0 +1,147 @@
+#include "storage.h"
+
+#ifdef STORAGE_SPI_FRAM
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hal.h"
+
+using namespace Storage;
+
+namespace
+{
+    // Chip select pin, SPI uses D11 (MOSI), D12 (MISO) and D13 (SCK)
+    constexpr uint8_t chipSelectPin = 8;
+    constexpr unsigned long spiClockHz = 8000000;
+
+    /**
+     * @brief MB85RS256B commands
+     */
+    enum Command : uint8_t
+    {
+        Command_WriteEnable = 0x06,
+        Command_Write = 0x02,
+        Command_Read = 0x03,
+    };
+
+    /**
+     * @brief Select chip and send command with the memory address
+     *
+     * @param command Command to send
+     * @param address Memory address
+     */
+    void begin(Command command, uint32_t address)
+    {
+        Hal::Gpio::write(chipSelectPin, Hal::Gpio::levelLow);
+        Hal::Spi::transfer(command);
+        Hal::Spi::transfer(address >> 8);
+        Hal::Spi::transfer(address & 0xFF);
+    }
+
+    /**
+     * @brief Deselect chip to complete the command
+     */
+    void end()
+    {
+        Hal::Gpio::write(chipSelectPin, Hal::Gpio::levelHigh);
+    }
+
+    /**
+     * @brief Enable write of the next command, write latch is reset by every write
+     */
+    void enableWrite()
+    {
+        Hal::Gpio::write(chipSelectPin, Hal::Gpio::levelLow);
+        Hal::Spi::transfer(Command_WriteEnable);
+        end();
+    }
+} // namespace
+
+/**
+ * @brief Initialize storage
+ */
+void Storage::initialize()
+{
+    Hal::Gpio::setMode(chipSelectPin, Hal::Gpio::Mode::Output);
+    end();
+    Hal::Spi::initialize(spiClockHz);
+}
+
+/**
+ * @brief Read data from the storage
+ *
+ * @param address Data start address
+ * @param data Buffer for data
+ * @param length Data length, bytes
+ */
+void Storage::read(uint32_t address, void *data, uint16_t length)
+{
+    uint8_t *pData = (uint8_t *)data;
+
+    begin(Command_Read, address);
+    for (uint16_t idx = 0; idx < length; idx++)
+    {
+        pData[idx] = Hal::Spi::transfer(0xFF);
+    }
+    end();
+}
+
+/**
+ * @brief Write data to the storage
+ * FRAM has no write delay, write is completed on return
+ *
+ * @param address Data start address
+ * @param data Data to write
+ * @param length Data length, bytes
+ */
+void Storage::write(uint32_t address, const void *data, uint16_t length)
+{
+    const uint8_t *pData = (const uint8_t *)data;
+
+    enableWrite();
+    begin(Command_Write, address);
+    for (uint16_t idx = 0; idx < length; idx++)
+    {
+        Hal::Spi::transfer(pData[idx]);
+    }
+    end();
+}
+
+/**
+ * @brief Fill storage range with the same value
+ * FRAM has no write delay, fill is completed on return
+ *
+ * @param address Range start address
+ * @param value Byte value to fill
+ * @param length Range length, bytes
+ */
+void Storage::fill(uint32_t address, uint8_t value, uint16_t length)
+{
+    enableWrite();
+    begin(Command_Write, address);
+    for (uint16_t idx = 0; idx < length; idx++)
+    {
+        Hal::Spi::transfer(value);
+    }
+    end();
+}
+
+/**
+ * @brief Check if there are writes not committed to the storage yet
+ *
+ * @return Always false, writes are completed immediately
+ */
+bool Storage::isPending()
+{
+    return false;
+}
+
+/**
+ * @brief Wait until all writes are committed
+ */
+void Storage::flush()
+{
+}
+
+#endif // STORAGE_SPI_FRAM
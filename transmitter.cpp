@@ -0,0 +1,499 @@
+#include "transmitter.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hal.h"
+#include "protocol.h"
+
+using namespace Transmitter;
+
+namespace
+{
+    // Delay of the first event after idle, microseconds
+    constexpr uint16_t startDelayUs = 50;
+    // Time to prepare the first pulse before it starts, microseconds
+    constexpr uint16_t prepareTimeUs = 500;
+
+    /**
+     * @brief Indexes of the pulse durations in the waveform
+     */
+    enum Duration : uint8_t
+    {
+        Duration_SyncHigh,
+        Duration_SyncLow,
+        Duration_ZeroHigh,
+        Duration_ZeroLow,
+        Duration_OneHigh,
+        Duration_OneLow,
+    };
+    static_assert(Duration_OneLow < durationsCount);
+
+    /**
+     * @brief Queued signal with its encoded waveform
+     */
+    struct Item
+    {
+        Waveform waveform;
+        uint8_t repeatCount;
+        uint16_t gapMs;
+    };
+
+    /**
+     * @brief Pulse schedule steps
+     */
+    enum class Step : uint8_t
+    {
+        NextItem,
+        Frame,
+        Gap,
+    };
+
+    Item queue[queueSize];
+    // Index of the item being sent
+    volatile uint8_t queueHead = 0;
+    volatile uint8_t queueCount = 0;
+    volatile bool isRunning = false;
+    volatile uint16_t framesSent = 0;
+    uint8_t txPin = 0;
+    Output output = Output::Interrupt;
+    EdgeStats edgeStats = {};
+
+    // Schedule state, owned by the timer interrupt while running
+    const Waveform *pWaveform = nullptr;
+    Step step = Step::NextItem;
+    uint8_t pulseIdx = 0;
+    uint8_t framesLeft = 0;
+    // Level of the current pulse and rest of its time which doesn't fit into one timer event
+    uint8_t level = Hal::Gpio::levelLow;
+    uint32_t delayLeftUs = 0;
+    // Pulse following the current one, prepared while the current one is sent
+    uint8_t nextLevel = Hal::Gpio::levelLow;
+    uint32_t nextDelayUs = 0;
+
+    /**
+     * @brief Append pulse to the waveform
+     *
+     * @param waveform Waveform being encoded
+     * @param duration Pulse duration index
+     */
+    void addPulse(Waveform &waveform, Duration duration)
+    {
+        uint8_t &pulses = waveform.pulses[waveform.pulsesCount / 2];
+        pulses = ((waveform.pulsesCount % 2) == 0) ? duration : (pulses | (duration << 4));
+        waveform.pulsesCount++;
+    }
+
+    /**
+     * @brief Return duration of the waveform pulse
+     *
+     * @param waveform Encoded waveform
+     * @param pulseIdx Pulse index
+     * @return Pulse duration, microseconds
+     */
+    inline uint16_t getPulseDuration(const Waveform &waveform, uint8_t pulseIdx)
+    {
+        uint8_t pulses = waveform.pulses[pulseIdx / 2];
+        uint8_t duration = ((pulseIdx % 2) == 0) ? (pulses & 0x0F) : (pulses >> 4);
+        return waveform.durationsUs[duration];
+    }
+
+    /**
+     * @brief Check if the signal can be sent
+     *
+     * @param signal Signal to check
+     * @param timing Object to copy the protocol timing
+     * @return true if protocol and bit length are supported, false otherwise
+     */
+    bool isValid(const Slot::Signal &signal, Protocol::Timing &timing)
+    {
+        return (Protocol::getTiming(signal.protocol, timing) == true &&
+                signal.bitLength > 0 && signal.bitLength <= 32);
+    }
+
+    /**
+     * @brief Return the free item following the queued ones
+     * Interrupt doesn't touch the free item, so it is filled with interrupts enabled
+     *
+     * @return Item to fill, nullptr if queue is full
+     */
+    Item *getFreeItem()
+    {
+        Item *pItem = nullptr;
+        uint8_t state = Hal::Interrupts::lock();
+        if (queueCount < queueSize)
+        {
+            pItem = &queue[(queueHead + queueCount) % queueSize];
+        }
+        Hal::Interrupts::restore(state);
+
+        return pItem;
+    }
+
+    /**
+     * @brief Advance pulse schedule to the next level change
+     *
+     * @param level Carrier level to set
+     * @return Time to hold the level, microseconds, 0 if nothing is left to send
+     */
+    uint32_t getNextPulse(uint8_t &level)
+    {
+        while (true)
+        {
+            const Item &item = queue[queueHead];
+
+            switch (step)
+            {
+            case Step::NextItem:
+                if (queueCount == 0)
+                {
+                    level = Hal::Gpio::levelLow;
+                    return 0;
+                }
+                pWaveform = &item.waveform;
+                framesLeft = item.repeatCount;
+                pulseIdx = 0;
+                step = Step::Frame;
+                break;
+
+            case Step::Frame:
+            {
+                bool isFirstLevel = ((pulseIdx % 2) == 0);
+                level = (isFirstLevel != pWaveform->isInverted) ? Hal::Gpio::levelHigh : Hal::Gpio::levelLow;
+                uint16_t durationUs = getPulseDuration(*pWaveform, pulseIdx);
+                if (++pulseIdx == pWaveform->pulsesCount)
+                {
+                    pulseIdx = 0;
+                    framesSent++;
+                    if (--framesLeft == 0)
+                    {
+                        step = Step::Gap;
+                    }
+                }
+                return durationUs;
+            }
+
+            case Step::Gap:
+            {
+                uint16_t gapMs = item.gapMs;
+                // Release the item, the next one starts after the gap
+                queueHead = (queueHead + 1) % queueSize;
+                queueCount--;
+                step = Step::NextItem;
+                if (gapMs > 0)
+                {
+                    level = Hal::Gpio::levelLow;
+                    return gapMs * 1000UL;
+                }
+                break;
+            }
+            }
+        }
+    }
+
+    /**
+     * @brief Add the filled free item to the queue, sending starts if transmitter is idle
+     */
+    void push()
+    {
+        uint8_t state = Hal::Interrupts::lock();
+        queueCount++;
+
+        if (isRunning == true && step == Step::NextItem && nextDelayUs == 0)
+        {
+            // Last pulse is being sent and the timer stops after it, the item follows it instead
+            nextDelayUs = getNextPulse(nextLevel);
+            if (output == Output::Timer && delayLeftUs == 0)
+            {
+                Hal::Timer::setOutputLevel(nextLevel);
+            }
+        }
+        else if (isRunning == false)
+        {
+            step = Step::NextItem;
+            // Low level is held while the first pulse is prepared
+            level = Hal::Gpio::levelLow;
+            delayLeftUs = 0;
+            nextLevel = Hal::Gpio::levelLow;
+            nextDelayUs = prepareTimeUs;
+            isRunning = true;
+            Hal::Timer::start(startDelayUs);
+        }
+        Hal::Interrupts::restore(state);
+    }
+
+    /**
+     * @brief Account edge delay against its time
+     *
+     * @param errorUs Edge delay, microseconds
+     */
+    void addEdge(uint16_t errorUs)
+    {
+        edgeStats.edgesCount++;
+        if (errorUs > edgeStats.errorMaxUs)
+        {
+            edgeStats.errorMaxUs = errorUs;
+        }
+    }
+
+    /**
+     * @brief Timer interrupt handler, starts the prepared pulse and prepares the next one
+     */
+    void onTimer()
+    {
+        if (delayLeftUs == 0)
+        {
+            if (output == Output::Interrupt)
+            {
+                // Edge is delayed by the interrupt latency
+                uint16_t errorUs = Hal::Timer::getElapsedUs();
+                Hal::Rf::setTransmitLevel(nextLevel);
+                if (nextLevel != level)
+                {
+                    addEdge(errorUs);
+                }
+            }
+            else if (nextLevel != level)
+            {
+                // Timer hardware has already switched the level
+                addEdge(0);
+            }
+
+            if (nextDelayUs == 0)
+            {
+                // Last pulse has left the carrier off
+                Hal::Timer::stop();
+                isRunning = false;
+                return;
+            }
+            level = nextLevel;
+            delayLeftUs = nextDelayUs;
+            nextDelayUs = getNextPulse(nextLevel);
+        }
+
+        // Long levels are split into several timer events
+        uint16_t delayUs = (delayLeftUs > Hal::Timer::delayMaxUs) ? Hal::Timer::delayMaxUs : delayLeftUs;
+        delayLeftUs -= delayUs;
+        if (Hal::Timer::scheduleNext(delayUs) == false)
+        {
+            // Interrupt came too late to set the event in time
+            edgeStats.lateCount++;
+            uint16_t errorUs = Hal::Timer::getElapsedUs() - delayUs;
+            if (errorUs > edgeStats.errorMaxUs)
+            {
+                edgeStats.errorMaxUs = errorUs;
+            }
+        }
+
+        if (output == Output::Timer)
+        {
+            // Level is kept on the events splitting the long pulse
+            Hal::Timer::setOutputLevel((delayLeftUs == 0) ? nextLevel : level);
+        }
+    }
+} // namespace
+
+/**
+ * @brief Initialize transmitter
+ *
+ * @param txPin TX pin number
+ */
+void Transmitter::initialize(uint8_t txPin)
+{
+    ::txPin = txPin;
+    output = (txPin == Hal::Timer::outputPin) ? Output::Timer : Output::Interrupt;
+    Hal::Rf::enableTransmit(txPin);
+    Hal::Timer::setHandler(onTimer);
+}
+
+/**
+ * @brief Select carrier output mode
+ *
+ * @param output New output mode
+ * @return true if mode is selected, false if transmitter is busy or TX pin doesn't support it
+ */
+bool Transmitter::setOutput(Output output)
+{
+    if (isRunning == true ||
+        (output == Output::Timer && txPin != Hal::Timer::outputPin))
+    {
+        return false;
+    }
+
+    ::output = output;
+    return true;
+}
+
+/**
+ * @brief Return current carrier output mode
+ */
+Output Transmitter::getOutput()
+{
+    return output;
+}
+
+/**
+ * @brief Encode signal frame waveform
+ *
+ * @param signal Signal to encode
+ * @param waveform Object to store the waveform
+ * @return true if signal is encoded, false if it can't be sent
+ */
+bool Transmitter::encode(const Slot::Signal &signal, Waveform &waveform)
+{
+    Protocol::Timing timing;
+    if (isValid(signal, timing) == false)
+    {
+        return false;
+    }
+
+    // Signal is sent with the pulse length of the remote it was received from
+    uint16_t pulseLengthUs = (signal.pulseLengthUs != 0) ? signal.pulseLengthUs : timing.pulseLength;
+
+    const Protocol::Pulses pulsePairs[] = {timing.sync, timing.zero, timing.one};
+    for (uint8_t pairIdx = 0; pairIdx < sizeof(pulsePairs) / sizeof(*pulsePairs); pairIdx++)
+    {
+        waveform.durationsUs[pairIdx * 2] = pulsePairs[pairIdx].high * pulseLengthUs;
+        waveform.durationsUs[pairIdx * 2 + 1] = pulsePairs[pairIdx].low * pulseLengthUs;
+    }
+    waveform.isInverted = timing.isInverted;
+
+    // Data bits MSB first, sync follows them
+    waveform.pulsesCount = 0;
+    for (int8_t bitIdx = signal.bitLength - 1; bitIdx >= 0; bitIdx--)
+    {
+        bool isOne = ((signal.value >> bitIdx) & 1UL);
+        addPulse(waveform, isOne ? Duration_OneHigh : Duration_ZeroHigh);
+        addPulse(waveform, isOne ? Duration_OneLow : Duration_ZeroLow);
+    }
+    addPulse(waveform, Duration_SyncHigh);
+    addPulse(waveform, Duration_SyncLow);
+
+    return true;
+}
+
+/**
+ * @brief Queue signal to send after the already queued ones
+ * Sending starts immediately if the transmitter is idle
+ *
+ * @param signal Signal to send
+ * @param repeatCount Number of frames sent back-to-back
+ * @param gapMs Silence after the last frame, milliseconds
+ * @return true if signal is queued, false if queue is full or signal can't be sent
+ */
+bool Transmitter::enqueue(const Slot::Signal &signal, uint8_t repeatCount, uint16_t gapMs)
+{
+    if (repeatCount == 0)
+    {
+        return false;
+    }
+
+    Item *pItem = getFreeItem();
+    // Signal is encoded here once for all its frames, the interrupt only replays the pulses
+    if (pItem == nullptr || encode(signal, pItem->waveform) == false)
+    {
+        return false;
+    }
+
+    pItem->repeatCount = repeatCount;
+    pItem->gapMs = gapMs;
+    push();
+
+    return true;
+}
+
+/**
+ * @brief Queue encoded waveform to send after the already queued signals
+ * Waveform is copied to the queue, the caller's one can be reused right away
+ *
+ * @param waveform Waveform encoded by encode() or unpacked by RawFrame::decode()
+ * @param repeatCount Number of frames sent back-to-back
+ * @param gapMs Silence after the last frame, milliseconds
+ * @return true if waveform is queued, false if queue is full
+ */
+bool Transmitter::enqueue(const Waveform &waveform, uint8_t repeatCount, uint16_t gapMs)
+{
+    if (waveform.pulsesCount == 0 || repeatCount == 0)
+    {
+        return false;
+    }
+
+    Item *pItem = getFreeItem();
+    if (pItem == nullptr)
+    {
+        return false;
+    }
+
+    pItem->waveform = waveform;
+    pItem->repeatCount = repeatCount;
+    pItem->gapMs = gapMs;
+    push();
+
+    return true;
+}
+
+/**
+ * @brief Return number of queued signals, including the one being sent
+ */
+uint8_t Transmitter::getQueuedCount()
+{
+    return queueCount;
+}
+
+/**
+ * @brief Check if transmitter is sending a signal or holding a gap
+ *
+ * @return true if transmitter is busy, false if it is idle
+ */
+bool Transmitter::isBusy()
+{
+    return isRunning;
+}
+
+/**
+ * @brief Stop sending immediately and drop all queued signals
+ */
+void Transmitter::stop()
+{
+    uint8_t state = Hal::Interrupts::lock();
+    Hal::Timer::stop();
+    Hal::Rf::setTransmitLevel(Hal::Gpio::levelLow);
+    isRunning = false;
+    queueCount = 0;
+    Hal::Interrupts::restore(state);
+}
+
+/**
+ * @brief Return number of frames sent since initialization
+ * Counter wraps around, compare differences of two values
+ */
+uint16_t Transmitter::getFramesSent()
+{
+    uint8_t state = Hal::Interrupts::lock();
+    uint16_t result = framesSent;
+    Hal::Interrupts::restore(state);
+
+    return result;
+}
+
+/**
+ * @brief Return edge timing of the frames sent since the last reset
+ *
+ * @param stats Object to copy the edge timing
+ */
+void Transmitter::getEdgeStats(EdgeStats &stats)
+{
+    uint8_t state = Hal::Interrupts::lock();
+    stats = edgeStats;
+    Hal::Interrupts::restore(state);
+}
+
+/**
+ * @brief Reset edge timing
+ */
+void Transmitter::resetEdgeStats()
+{
+    uint8_t state = Hal::Interrupts::lock();
+    edgeStats = {};
+    Hal::Interrupts::restore(state);
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "slot.h"
+
+/**
+ * Non-blocking radio transmitter
+ *
+ * Signals are queued with their repeat count and the gap after them, queue is played
+ * from the timer interrupt while the caller keeps running, one level change per timer event.
+ * On the timer output pin the level is switched by the timer hardware, so edges don't move
+ * with the interrupt latency, the interrupt only prepares the next edge.
+ * Signals are encoded into waveforms when they are queued, so the interrupt only replays
+ * the encoded pulses. A waveform encoded by the caller can be queued directly to skip
+ * encoding for repeated sends.
+ */
+namespace Transmitter
+{
+    // Number of queued signals, including the one being sent, every one keeps its waveform
+    static constexpr uint8_t queueSize = 4;
+    // Maximum number of pulses per frame: 32 data bits and sync, two pulses each
+    static constexpr uint8_t pulsesMax = (32 + 1) * 2;
+    // Number of distinct pulse durations: sync, zero and one pulse pairs use 6, raw frames up to 8
+    static constexpr uint8_t durationsCount = 8;
+
+    /**
+     * @brief Carrier output modes
+     */
+    enum class Output : uint8_t
+    {
+        Timer,     // Level is switched by the timer hardware, TX pin should be Hal::Timer::outputPin
+        Interrupt, // Level is written from the timer interrupt
+    };
+
+    /**
+     * @brief Edge timing of the sent frames
+     */
+    struct EdgeStats
+    {
+        // Number of sent edges
+        uint16_t edgesCount;
+        // Worst edge delay against the waveform durations, microseconds
+        uint16_t errorMaxUs;
+        // Number of edges sent after their time
+        uint16_t lateCount;
+    };
+
+    /**
+     * @brief Encoded frame waveform
+     * Pulses alternate the carrier level starting from the first level of the protocol,
+     * every pulse is stored as 4-bit index of its duration
+     */
+    struct Waveform
+    {
+        uint16_t durationsUs[durationsCount];
+        uint8_t pulses[pulsesMax / 2];
+        uint8_t pulsesCount;
+        bool isInverted;
+    };
+
+    /**
+     * @brief Initialize transmitter
+     * Timer output is used if TX pin is the timer output pin
+     *
+     * @param txPin TX pin number
+     */
+    void initialize(uint8_t txPin);
+
+    /**
+     * @brief Select carrier output mode
+     *
+     * @param output New output mode
+     * @return true if mode is selected, false if transmitter is busy or TX pin doesn't support it
+     */
+    bool setOutput(Output output);
+
+    /**
+     * @brief Return current carrier output mode
+     */
+    Output getOutput();
+
+    /**
+     * @brief Encode signal frame waveform
+     *
+     * @param signal Signal to encode
+     * @param waveform Object to store the waveform
+     * @return true if signal is encoded, false if it can't be sent
+     */
+    bool encode(const Slot::Signal &signal, Waveform &waveform);
+
+    /**
+     * @brief Queue signal to send after the already queued ones
+     * Sending starts immediately if the transmitter is idle
+     *
+     * @param signal Signal to send
+     * @param repeatCount Number of frames sent back-to-back
+     * @param gapMs Silence after the last frame, milliseconds
+     * @return true if signal is queued, false if queue is full or signal can't be sent
+     */
+    bool enqueue(const Slot::Signal &signal, uint8_t repeatCount, uint16_t gapMs);
+
+    /**
+     * @brief Queue encoded waveform to send after the already queued signals
+     * Waveform is copied to the queue, the caller's one can be reused right away
+     *
+     * @param waveform Waveform encoded by encode() or unpacked by RawFrame::decode()
+     * @param repeatCount Number of frames sent back-to-back
+     * @param gapMs Silence after the last frame, milliseconds
+     * @return true if waveform is queued, false if queue is full
+     */
+    bool enqueue(const Waveform &waveform, uint8_t repeatCount, uint16_t gapMs);
+
+    /**
+     * @brief Return number of queued signals, including the one being sent
+     */
+    uint8_t getQueuedCount();
+
+    /**
+     * @brief Check if transmitter is sending a signal or holding a gap
+     *
+     * @return true if transmitter is busy, false if it is idle
+     */
+    bool isBusy();
+
+    /**
+     * @brief Stop sending immediately and drop all queued signals
+     */
+    void stop();
+
+    /**
+     * @brief Return number of frames sent since initialization
+     * Counter wraps around, compare differences of two values
+     */
+    uint16_t getFramesSent();
+
+    /**
+     * @brief Return edge timing of the frames sent since the last reset
+     *
+     * @param stats Object to copy the edge timing
+     */
+    void getEdgeStats(EdgeStats &stats);
+
+    /**
+     * @brief Reset edge timing
+     */
+    void resetEdgeStats();
+} // namespace Transmitter